@@ -2,6 +2,17 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* a file mapped into memory, read by moving pos.spos between base and end */
+typedef struct cs_mmap_t {
+	char *base;
+	char *end;
+	size_t len;
+} cs_mmap_t;
 
 /* memory management */
 static cs_t *cs_context_alloc(cs_type_t type, void *stream,
@@ -160,9 +171,104 @@ static void close_file2char(cs_t *cs)
 	cs_context_free(cs);
 }
 
+/* mmap2char */
+static int getc_mmap2char(cs_t *cs)
+{
+	if (cs->pos.spos == ((cs_mmap_t *)cs->stream)->end)
+		return cs->c = EOF;
+
+	return cs->c = (unsigned char)*cs->pos.spos++;
+}
+
+static int ungetc_mmap2char(cs_t *cs)
+{
+	return cs->c = cs->c == EOF ? EOF : (unsigned char)*--cs->pos.spos;
+}
+
+static long getpos_mmap2char(cs_t *cs)
+{
+	return (long)(cs->pos.spos - ((cs_mmap_t *)cs->stream)->base);
+}
+
+static int setpos_mmap2char(cs_t *cs, int n)
+{
+	cs_mmap_t *m = (cs_mmap_t *)cs->stream;
+
+	if (cs->pos.spos + n < m->base || cs->pos.spos + n > m->end)
+		return -1;
+	cs->pos.spos += n;
+	return 0;
+}
+
+static void rewind_mmap2char(cs_t *cs)
+{
+	cs->pos.spos = ((cs_mmap_t *)cs->stream)->base;
+	cs->c = EOF;
+}
+
+static cs_t *open_mmap2char(char *file)
+{
+	cs_mmap_t *m;
+	struct stat st;
+	cs_t *cs;
+	int fd;
+
+	if ((fd = open(file, O_RDONLY)) == -1) {
+		fprintf(stderr, "could not open file: %s\n", file);
+		return NULL;
+	}
+
+	if (fstat(fd, &st) || !(m = calloc(1, sizeof(cs_mmap_t))))
+		goto Error;
+
+	/* an empty file has nothing to map, it reads as an immediate EOF */
+	if ((m->len = st.st_size)) {
+		if ((m->base = mmap(NULL, m->len, PROT_READ, MAP_PRIVATE, fd,
+			0)) == MAP_FAILED) {
+			free(m);
+			goto Error;
+		}
+		madvise(m->base, m->len, MADV_SEQUENTIAL);
+	}
+	m->end = m->base + m->len;
+	close(fd);
+
+	if (!(cs = cs_context_alloc(CS_MMAP2CHAR, m, getc_mmap2char,
+		ungetc_mmap2char, getpos_mmap2char, setpos_mmap2char,
+		rewind_mmap2char))) {
+		if (m->len)
+			munmap(m->base, m->len);
+		free(m);
+		return NULL;
+	}
+
+	cs->pos.spos = m->base;
+	return cs;
+
+Error:
+	fprintf(stderr, "could not map file: %s\n", file);
+	close(fd);
+	return NULL;
+}
+
+static void close_mmap2char(cs_t *cs)
+{
+	cs_mmap_t *m = (cs_mmap_t *)cs->stream;
+
+	if (m->len)
+		munmap(m->base, m->len);
+	free(m);
+	cs_context_free(cs);
+}
+
 /* stream functions */
 int cs_getc(cs_t *cs)
 {
+	/* the parser reads its input one character at a time, spare mapped
+	 * files the indirect call */
+	if (cs->type == CS_MMAP2CHAR)
+		return getc_mmap2char(cs);
+
 	return cs->stream_getc(cs);
 }
 
@@ -186,6 +292,16 @@ void cs_rewind(cs_t *cs)
 	cs->stream_rewind(cs);
 }
 
+/* regular files are mapped into memory, anything else (pipes, devices) is
+ * read through stdio */
+cs_type_t cs_file_type(char *file)
+{
+	struct stat st;
+
+	return !stat(file, &st) && S_ISREG(st.st_mode) ? CS_MMAP2CHAR :
+		CS_FILE2CHAR;
+}
+
 cs_t *cs_open(cs_type_t type, char *data)
 {
 	cs_t *cs;
@@ -198,6 +314,9 @@ cs_t *cs_open(cs_type_t type, char *data)
 	case CS_FILE2CHAR:
 		cs = open_file2char((char *)data);
 		break;
+	case CS_MMAP2CHAR:
+		cs = open_mmap2char((char *)data);
+		break;
 	default:
 		cs = NULL;
 		break;
@@ -216,6 +335,9 @@ void cs_close(cs_t *cs)
 	case CS_FILE2CHAR:
 		close_file2char(cs);
 		break;
+	case CS_MMAP2CHAR:
+		close_mmap2char(cs);
+		break;
 	default:
 		break;
 	}
@@ -4,6 +4,7 @@
 typedef enum cs_type_t {
 	CS_STRING2CHAR = 0,
 	CS_FILE2CHAR = 1,
+	CS_MMAP2CHAR = 2,
 } cs_type_t;
 
 typedef struct cs_t {
@@ -21,6 +22,7 @@ typedef struct cs_t {
 	} pos;
 } cs_t;
 
+cs_type_t cs_file_type(char *file);
 cs_t *cs_open(cs_type_t type, char *data);
 void cs_close(cs_t *cs);
 int cs_getc(cs_t *cs);
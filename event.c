@@ -1,11 +1,16 @@
 #include <stdlib.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <poll.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <string.h>
-#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <stdio.h>
+#include <assert.h>
 #include "event.h"
+#include "util.h"
 
 typedef enum event_status_t {
 	EVENT_CONTINUE = 0,
@@ -15,19 +20,169 @@ typedef enum event_status_t {
 
 typedef unsigned long long sig_mask_t;
 
-static int stamp_now;
-static sig_mask_t signals;
-static event_t *event_list, **event_list_tail;
-static fd_t *fd_list;
-static int fd_max;
-static fd_set fd_read, fd_write, fd_excep;
-static sig_table_t *signal_table[SIG_COUNT];
+/* pending events are indexed by their data pointer. all events sharing the
+ * same data pointer land in the same bucket, so both the (func, data)
+ * duplicate check and the deletions by data only ever walk the few events
+ * queued on behalf of a single object */
+#define EVENT_HASH_BITS_MIN 10
+#define EVENT_HASH_MULT 0x9e3779b97f4a7c15ULL
+
+#define EVENT_RING_SZ_MIN 1024
+
+/* maximum number of ready fds collected per epoll_wait() */
+#define FD_EPOLL_EVENTS 64
+
+/* timers are kept in a hierarchical timing wheel of TIMER_WHEEL_LEVELS
+ * levels, each of TIMER_WHEEL_SZ slots. level 0 slots are one tick wide, and
+ * the slots of each following level are TIMER_WHEEL_SZ times wider. timers
+ * are cascaded down a level whenever the level below wraps around */
+#define TIMER_TICK_USEC 1000
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SZ (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SZ - 1)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SHIFT(level) ((level) * TIMER_WHEEL_BITS)
+#define TIMER_DELTA_MAX \
+	((1ULL << TIMER_WHEEL_SHIFT(TIMER_WHEEL_LEVELS)) - 1)
+
+/* number of nodes carved out of each pool slab */
+#define POOL_SLAB_NODES 1024
+
+/* a free node's first word links it into its pool's free list */
+typedef struct pool_node_t {
+	struct pool_node_t *next;
+} pool_node_t;
+
+typedef struct pool_slab_t {
+	struct pool_slab_t *next;
+} pool_slab_t;
+
+/* a queued event. each generation's events are kept by value in a ring */
+typedef struct event_entry_t {
+	event_func_t func;
+	void *data;
+} event_entry_t;
+
+/* sz is always a power of 2 */
+typedef struct event_ring_t {
+	event_entry_t *buf;
+	unsigned long head;
+	unsigned long num;
+	unsigned long sz;
+} event_ring_t;
+
+typedef struct pool_t {
+	pool_node_t *free_list;
+	pool_slab_t *slabs;
+	size_t node_sz;
+	event_pool_stat_t stat;
+} pool_t;
+
+#ifdef EVENT_PROFILE
+typedef struct event_profile_t event_profile_t;
+#endif
+
+/* an event loop instance. all the loop's state lives here so that each thread
+ * can run a loop of its own */
+struct event_ctx_t {
+	int stamp_now;
+	sig_mask_t signals;
+	event_ring_t event_rings[2], *event_ring_now, *event_ring_next;
+	unsigned long event_live;
+	event_t **event_hash;
+	int event_hash_bits;
+	unsigned long event_num;
+	fd_t *fd_list;
+	int fd_epoll;
+	sig_table_t *signal_table[SIG_COUNT];
+	event_timer_t *timer_wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SZ];
+	unsigned long long timer_now;
+	unsigned long timer_num;
+	pool_t pools[EVENT_POOL_COUNT];
+#ifdef EVENT_PROFILE
+	event_profile_t *profile_hash;
+	int profile_hash_bits;
+	unsigned long profile_num;
+#endif
+};
+
+/* the loop the calling thread runs, all of the event API acts on it */
+static __thread event_ctx_t *ctx;
+
+/* a debug build checks that the calling thread has a loop set */
+#ifdef EVENT_DEBUG
+#define EVENT_CTX_ASSERT() assert(ctx)
+#else
+#define EVENT_CTX_ASSERT() do { } while (0)
+#endif
+
+/* carves a new slab into nodes and pushes them onto the free list */
+static int pool_grow(pool_t *pool)
+{
+	pool_slab_t *slab;
+	char *node;
+	int i;
+
+	if (!(slab = malloc(sizeof(pool_slab_t) +
+		POOL_SLAB_NODES * pool->node_sz))) {
+		return -1;
+	}
+
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+	pool->stat.slabs++;
+
+	node = (char *)(slab + 1);
+	for (i = 0; i < POOL_SLAB_NODES; i++, node += pool->node_sz) {
+		((pool_node_t *)node)->next = pool->free_list;
+		pool->free_list = (pool_node_t *)node;
+	}
+
+	return 0;
+}
+
+static void *pool_alloc(pool_t *pool)
+{
+	pool_node_t *node;
+
+	if (!pool->free_list && pool_grow(pool))
+		return NULL;
+
+	node = pool->free_list;
+	pool->free_list = node->next;
+	if (++pool->stat.in_use > pool->stat.high_water)
+		pool->stat.high_water = pool->stat.in_use;
+	return node;
+}
+
+static void pool_free(pool_t *pool, void *o)
+{
+	pool_node_t *node = (pool_node_t *)o;
+
+	node->next = pool->free_list;
+	pool->free_list = node;
+	pool->stat.in_use--;
+}
+
+/* releases all slabs of a pool, all its nodes must have been freed */
+static void pool_uninit(pool_t *pool)
+{
+	pool_slab_t *slab;
+
+	while ((slab = pool->slabs)) {
+		pool->slabs = slab->next;
+		free(slab);
+	}
+
+	pool->free_list = NULL;
+	memset(&pool->stat, 0, sizeof(event_pool_stat_t));
+}
 
 static sig_table_t *alloc_sig_table_t(sig_t signal, sig_func_t func, void *data)
 {
 	sig_table_t *s;
 
-	if (!(s = malloc(sizeof(sig_table_t))))
+	if (!(s = pool_alloc(&ctx->pools[EVENT_POOL_SIG])))
 		return NULL;
 
 	s->next = NULL;
@@ -39,20 +194,20 @@ static sig_table_t *alloc_sig_table_t(sig_t signal, sig_func_t func, void *data)
 
 static void free_sig_table_t(sig_table_t *s)
 {
-	free(s);
+	pool_free(&ctx->pools[EVENT_POOL_SIG], s);
 }
 
 static fd_t *alloc_fd_t(int fd, int type, fd_func_t func, void *data)
 {
 	fd_t *efd;
 
-	if (!(efd = malloc(sizeof(fd_t))))
+	if (!(efd = pool_alloc(&ctx->pools[EVENT_POOL_FD])))
 		return NULL;
 
 	efd->next = NULL;
 	efd->fd = fd;
 	efd->type = type;
-	efd->stamp = stamp_now;
+	efd->stamp = ctx->stamp_now;
 	efd->func = func;
 	efd->data = data;
 	return efd;
@@ -60,33 +215,202 @@ static fd_t *alloc_fd_t(int fd, int type, fd_func_t func, void *data)
 
 static void free_fd_t(fd_t *efd)
 {
-	free(efd);
+	pool_free(&ctx->pools[EVENT_POOL_FD], efd);
 }
 
 static event_t *alloc_event_t(event_func_t func, void *data)
 {
 	event_t *e;
 
-	if (!(e = malloc(sizeof(event_t))))
+	if (!(e = pool_alloc(&ctx->pools[EVENT_POOL_EVENT])))
 		return NULL;
 
-	e->next = NULL;
+	e->hnext = NULL;
+	e->hpprev = NULL;
 	e->func = func;
 	e->data = data;
-	e->stamp = stamp_now;
+	e->pending = 0;
+	e->cancelled = 0;
+	e->scan = 0;
 	return e;
 }
 
 static void free_event_t(event_t *e)
 {
-	free(e);
+	pool_free(&ctx->pools[EVENT_POOL_EVENT], e);
+}
+
+#ifdef EVENT_PROFILE
+/* per callback dispatch statistics, kept in an open addressing table keyed by
+ * the callback's address. hist[i] counts the calls which took [2^i, 2^(i+1))
+ * nanoseconds */
+#define PROFILE_HASH_BITS_MIN 8
+#define PROFILE_HIST_SZ 32
+
+struct event_profile_t {
+	event_func_t func;
+	char *name;
+	unsigned long count;
+	unsigned long long total_ns;
+	unsigned long hist[PROFILE_HIST_SZ];
+};
+
+static unsigned long long profile_clock_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static event_profile_t *profile_slot(event_profile_t *hash, int bits,
+	event_func_t func)
+{
+	unsigned long mask = (1UL << bits) - 1;
+	unsigned long idx = (unsigned long)(((unsigned long long)
+		(unsigned long)func * EVENT_HASH_MULT) >>
+		(sizeof(unsigned long long) * 8 - bits));
+
+	while (hash[idx].func && hash[idx].func != func)
+		idx = (idx + 1) & mask;
+	return &hash[idx];
 }
 
+static int profile_hash_grow(void)
+{
+	event_profile_t *hash;
+	int i, bits = ctx->profile_hash_bits ? ctx->profile_hash_bits + 1 :
+		PROFILE_HASH_BITS_MIN;
+
+	if (!(hash = calloc(1UL << bits, sizeof(event_profile_t))))
+		return -1;
+
+	for (i = 0; ctx->profile_hash && i < 1 << ctx->profile_hash_bits; i++) {
+		if (ctx->profile_hash[i].func) {
+			*profile_slot(hash, bits, ctx->profile_hash[i].func) =
+				ctx->profile_hash[i];
+		}
+	}
+
+	free(ctx->profile_hash);
+	ctx->profile_hash = hash;
+	ctx->profile_hash_bits = bits;
+	return 0;
+}
+
+static event_profile_t *profile_get(event_func_t func)
+{
+	event_profile_t *p;
+
+	/* keep the load factor under one half */
+	if (2 * (ctx->profile_num + 1) > 1UL << ctx->profile_hash_bits &&
+		profile_hash_grow()) {
+		return NULL;
+	}
+
+	p = profile_slot(ctx->profile_hash, ctx->profile_hash_bits, func);
+	if (!p->func) {
+		p->func = func;
+		ctx->profile_num++;
+	}
+	return p;
+}
+
+void event_profile_register(event_profile_sym_t *syms)
+{
+	event_profile_t *p;
+
+	EVENT_CTX_ASSERT();
+	for ( ; syms->func; syms++) {
+		if ((p = profile_get(syms->func)))
+			p->name = syms->name;
+	}
+}
+
+static void event_call(event_func_t func, void *data)
+{
+	unsigned long long ns = profile_clock_ns();
+	event_profile_t *p;
+	int i;
+
+	func(data);
+	ns = profile_clock_ns() - ns;
+
+	if (!(p = profile_get(func)))
+		return;
+
+	for (i = 0; i < PROFILE_HIST_SZ - 1 && ns >> (i + 1); i++);
+	p->count++;
+	p->total_ns += ns;
+	p->hist[i]++;
+}
+
+static int profile_cmp(const void *a, const void *b)
+{
+	const event_profile_t *p1 = (const event_profile_t *)a;
+	const event_profile_t *p2 = (const event_profile_t *)b;
+
+	if (p1->total_ns == p2->total_ns)
+		return 0;
+	return p1->total_ns < p2->total_ns ? 1 : -1;
+}
+
+/* prints the dispatched callbacks, most time consuming first, and resets the
+ * statistics */
+void event_profile_report(void)
+{
+	int i, j, n;
+
+	EVENT_CTX_ASSERT();
+	if (!ctx->profile_hash)
+		return;
+
+	for (i = 0, n = 0; i < 1 << ctx->profile_hash_bits; i++) {
+		if (ctx->profile_hash[i].count)
+			ctx->profile_hash[n++] = ctx->profile_hash[i];
+	}
+	qsort(ctx->profile_hash, n, sizeof(event_profile_t), profile_cmp);
+
+	fprintf(stderr, "%-32s %12s %12s %10s  %s\n", "callback", "calls",
+		"total(us)", "avg(ns)", "histogram: calls per 2^i ns");
+	for (i = 0; i < n; i++) {
+		event_profile_t *p = &ctx->profile_hash[i];
+		char addr[2 * sizeof(void *) + 3];
+		int lo, hi;
+
+		if (!p->name)
+			snprintf(addr, sizeof(addr), "%p", (void *)p->func);
+		fprintf(stderr, "%-32s %12lu %12llu %10llu ",
+			p->name ? p->name : addr, p->count, p->total_ns / 1000,
+			p->total_ns / p->count);
+
+		for (lo = 0; !p->hist[lo]; lo++);
+		for (hi = PROFILE_HIST_SZ - 1; !p->hist[hi]; hi--);
+		fprintf(stderr, " i=%d:", lo);
+		for (j = lo; j <= hi; j++)
+			fprintf(stderr, " %lu", p->hist[j]);
+		fprintf(stderr, "\n");
+	}
+
+	free(ctx->profile_hash);
+	ctx->profile_hash = NULL;
+	ctx->profile_hash_bits = 0;
+	ctx->profile_num = 0;
+}
+#else
+static inline void event_call(event_func_t func, void *data)
+{
+	func(data);
+}
+#endif
+
 /* registers a task on a signal */
 int signal_register(sig_t signal, sig_func_t func, void *data)
 {
-	sig_table_t *s, **sptr = &(signal_table[signal]);
+	sig_table_t *s, **sptr;
 
+	EVENT_CTX_ASSERT();
+	sptr = &ctx->signal_table[signal];
 	if (!(s = alloc_sig_table_t(signal, func, data)))
 		return -1;
 
@@ -97,7 +421,8 @@ int signal_register(sig_t signal, sig_func_t func, void *data)
 
 void signal_set(sig_t s)
 {
-	signals |= (sig_mask_t)1 << s;
+	EVENT_CTX_ASSERT();
+	ctx->signals |= (sig_mask_t)1 << s;
 }
 
 static void signal_calls(void)
@@ -108,13 +433,13 @@ static void signal_calls(void)
 		sig_mask_t mask = 1 << s;
 		sig_table_t *sptr;
 
-		if (!(signals & mask))
+		if (!(ctx->signals & mask))
 			continue;
 
-		for (sptr = signal_table[s]; sptr; sptr = sptr->next)
+		for (sptr = ctx->signal_table[s]; sptr; sptr = sptr->next)
 			sptr->func(s, sptr->data);
 	}
-	signals = 0;
+	ctx->signals = 0;
 }
 
 /* cleanup the signal table */
@@ -125,88 +450,558 @@ static void signal_table_clean(void)
 	for (i = 0; i < SIG_COUNT; i++) {
 		sig_table_t *sptr;
 
-		while ((sptr = signal_table[i])) {
-			signal_table[i] = signal_table[i]->next;
+		while ((sptr = ctx->signal_table[i])) {
+			ctx->signal_table[i] = ctx->signal_table[i]->next;
 			free_sig_table_t(sptr);
 		}
 	}
 }
 
-/* adds an event to the end of the event list */
+static unsigned long event_hash_idx(void *data, int bits)
+{
+	return (unsigned long)(((unsigned long long)(unsigned long)data *
+		EVENT_HASH_MULT) >> (sizeof(unsigned long long) * 8 - bits));
+}
+
+static void event_hash_link(event_t **hash, int bits, event_t *e)
+{
+	event_t **bucket = &hash[event_hash_idx(e->data, bits)];
+
+	if ((e->hnext = *bucket))
+		(*bucket)->hpprev = &e->hnext;
+	e->hpprev = bucket;
+	*bucket = e;
+}
+
+static void event_hash_unlink(event_t *e)
+{
+	if ((*e->hpprev = e->hnext))
+		e->hnext->hpprev = e->hpprev;
+}
+
+/* doubles the number of buckets once the load factor exceeds 1. failing to
+ * grow is not an error, the index just gets more crowded */
+static void event_hash_grow(void)
+{
+	event_t **hash;
+	int i, bits = ctx->event_hash_bits + 1;
+
+	if (!(hash = calloc(1UL << bits, sizeof(event_t *))))
+		return;
+
+	for (i = 0; i < 1 << ctx->event_hash_bits; i++) {
+		event_t *e;
+
+		while ((e = ctx->event_hash[i])) {
+			event_hash_unlink(e);
+			event_hash_link(hash, bits, e);
+		}
+	}
+
+	free(ctx->event_hash);
+	ctx->event_hash = hash;
+	ctx->event_hash_bits = bits;
+}
+
+static int event_hash_init(void)
+{
+	if (!(ctx->event_hash = calloc(1UL << EVENT_HASH_BITS_MIN,
+		sizeof(event_t *)))) {
+		return -1;
+	}
+
+	ctx->event_hash_bits = EVENT_HASH_BITS_MIN;
+	return 0;
+}
+
+static void event_hash_uninit(void)
+{
+	free(ctx->event_hash);
+	ctx->event_hash = NULL;
+	ctx->event_hash_bits = 0;
+}
+
+/* returns the bucket holding all pending events for data */
+static event_t *event_hash_bucket(void *data)
+{
+	return ctx->event_hash ? ctx->event_hash[event_hash_idx(data,
+		ctx->event_hash_bits)] : NULL;
+}
+
+static event_t *event_find(event_func_t func, void *data)
+{
+	event_t *e;
+
+	for (e = event_hash_bucket(data); e && (e->func != func ||
+		e->data != data); e = e->hnext);
+	return e;
+}
+
+/* releases an index entry once none of its events are queued */
+static void event_put(event_t *e)
+{
+	if (e->pending)
+		return;
+
+	event_hash_unlink(e);
+	free_event_t(e);
+	ctx->event_num--;
+}
+
+/* drops every queued event and its index entry */
+static void event_queue_clear(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SZ(ctx->event_rings); i++) {
+		ctx->event_rings[i].head = 0;
+		ctx->event_rings[i].num = 0;
+	}
+
+	for (i = 0; ctx->event_hash && i < 1 << ctx->event_hash_bits; i++) {
+		event_t *e;
+
+		while ((e = ctx->event_hash[i])) {
+			e->pending = 0;
+			event_put(e);
+		}
+	}
+	ctx->event_live = 0;
+}
+
+static int event_ring_grow(event_ring_t *ring)
+{
+	event_entry_t *buf;
+	unsigned long i, sz = ring->sz ? ring->sz << 1 : EVENT_RING_SZ_MIN;
+
+	if (!(buf = malloc(sz * sizeof(event_entry_t))))
+		return -1;
+
+	for (i = 0; i < ring->num; i++)
+		buf[i] = ring->buf[(ring->head + i) & (ring->sz - 1)];
+
+	free(ring->buf);
+	ring->buf = buf;
+	ring->head = 0;
+	ring->sz = sz;
+	return 0;
+}
+
+static int event_ring_push(event_ring_t *ring, event_func_t func, void *data)
+{
+	event_entry_t *entry;
+
+	if (ring->num == ring->sz && event_ring_grow(ring))
+		return -1;
+
+	entry = &ring->buf[(ring->head + ring->num) & (ring->sz - 1)];
+	entry->func = func;
+	entry->data = data;
+	ring->num++;
+	return 0;
+}
+
+static int event_ring_pop(event_ring_t *ring, event_entry_t *entry)
+{
+	if (!ring->num)
+		return -1;
+
+	*entry = ring->buf[ring->head];
+	ring->head = (ring->head + 1) & (ring->sz - 1);
+	ring->num--;
+	return 0;
+}
+
+static void event_ring_uninit(event_ring_t *ring)
+{
+	free(ring->buf);
+	memset(ring, 0, sizeof(event_ring_t));
+}
+
+/* adds an event to the end of the next generation's queue */
 int event_add(event_func_t func, void *data)
 {
-	if (!(*event_list_tail = alloc_event_t(func, data)))
+	event_t *e;
+
+	EVENT_CTX_ASSERT();
+	if (!ctx->event_hash && event_hash_init())
 		return -1;
 
-	event_list_tail = &(*event_list_tail)->next;
+	if (!(e = event_find(func, data))) {
+		if (!(e = alloc_event_t(func, data)))
+			return -1;
+
+		event_hash_link(ctx->event_hash, ctx->event_hash_bits, e);
+		if (++ctx->event_num > 1UL << ctx->event_hash_bits)
+			event_hash_grow();
+	}
+
+	if (event_ring_push(ctx->event_ring_next, func, data)) {
+		event_put(e);
+		return -1;
+	}
+
+	e->pending++;
+	ctx->event_live++;
 	return 0;
 }
 
 int event_add_once(event_func_t func, void *data)
 {
-	event_t *tmp;
+	event_t *e;
+
+	EVENT_CTX_ASSERT();
+	e = event_find(func, data);
+	return e && e->pending > e->cancelled ? 0 : event_add(func, data);
+}
 
-	for (tmp = event_list; tmp && (tmp->func != func || tmp->data != data);
-		tmp = tmp->next);
-	return tmp ? 0 : event_add(func, data);
+/* a deleted event stays queued but is skipped when its turn comes. since the
+ * queues are FIFO, the first 'cancelled' events met for an index entry are
+ * the ones which were deleted */
+static void event_cancel(event_t *e, int num)
+{
+	e->cancelled += num;
+	ctx->event_live -= num;
 }
 
-/* deletes an event from the event list */
-static void event_del(void *data, int is_once)
+/* finds which index entry owns the oldest live event queued for data. only
+ * needed when several functions have events pending for the same data */
+static event_t *event_oldest(void *data)
 {
-	event_t **eptr = &event_list;
+	event_ring_t *rings[2] = { ctx->event_ring_now, ctx->event_ring_next };
+	event_t *e, *oldest = NULL;
+	unsigned long i;
+	int r;
 
-	while (*eptr) {
-		event_t *etmp;
+	for (r = 0; r < ARRAY_SZ(rings) && !oldest; r++) {
+		event_ring_t *ring = rings[r];
 
-		if ((*eptr)->data != data) {
-			eptr = &(*eptr)->next;
-			continue;
-		}
+		for (i = 0; i < ring->num && !oldest; i++) {
+			event_entry_t *entry =
+				&ring->buf[(ring->head + i) & (ring->sz - 1)];
+
+			if (entry->data != data)
+				continue;
 
-		etmp = *eptr;
-		*eptr = (*eptr)->next;
-		if (event_list_tail == &etmp->next)
-			event_list_tail = eptr;
-		free_event_t(etmp);
-		if (is_once)
-			return;
+			e = event_find(entry->func, data);
+			if (++e->scan > e->cancelled)
+				oldest = e;
+		}
 	}
+
+	for (e = event_hash_bucket(data); e; e = e->hnext)
+		e->scan = 0;
+	return oldest;
 }
 
 void event_del_once(void *data)
 {
-	event_del(data, 1);
+	event_t *e, *match = NULL;
+	int matches = 0;
+
+	EVENT_CTX_ASSERT();
+	for (e = event_hash_bucket(data); e; e = e->hnext) {
+		if (e->data != data || e->pending == e->cancelled)
+			continue;
+
+		match = e;
+		matches++;
+	}
+
+	if (matches > 1)
+		match = event_oldest(data);
+	if (match)
+		event_cancel(match, 1);
 }
 
 void event_del_all(void *data)
 {
-	event_del(data, 0);
+	event_t *e;
+
+	EVENT_CTX_ASSERT();
+	for (e = event_hash_bucket(data); e; e = e->hnext) {
+		if (e->data == data)
+			event_cancel(e, e->pending - e->cancelled);
+	}
+}
+
+/* whether any event for data is still to be called */
+int event_is_pending(void *data)
+{
+	event_t *e;
+
+	EVENT_CTX_ASSERT();
+	for (e = event_hash_bucket(data); e; e = e->hnext) {
+		if (e->data == data && e->pending != e->cancelled)
+			return 1;
+	}
+
+	return 0;
+}
+
+static unsigned long long timer_clock_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* current time in wheel ticks */
+static unsigned long long timer_clock(void)
+{
+	return timer_clock_usec() / TIMER_TICK_USEC;
+}
+
+static void timer_link(event_timer_t *t)
+{
+	unsigned long long delta = t->expires - ctx->timer_now;
+	event_timer_t **slot;
+	int level;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS - 1 &&
+		delta >= 1ULL << TIMER_WHEEL_SHIFT(level + 1); level++);
+
+	slot = &ctx->timer_wheel[level][(t->expires >>
+		TIMER_WHEEL_SHIFT(level)) & TIMER_WHEEL_MASK];
+	if ((t->next = *slot))
+		(*slot)->pprev = &t->next;
+	t->pprev = slot;
+	*slot = t;
+}
+
+static void timer_unlink(event_timer_t *t)
+{
+	if ((*t->pprev = t->next))
+		t->next->pprev = t->pprev;
+}
+
+/* re-files the timers of a slot into the lower levels. returns the slot's
+ * index so the caller knows whether this level has wrapped around too */
+static int timer_cascade(int level)
+{
+	int idx = (ctx->timer_now >> TIMER_WHEEL_SHIFT(level)) &
+		TIMER_WHEEL_MASK;
+	event_timer_t *t, *list = ctx->timer_wheel[level][idx];
+
+	ctx->timer_wheel[level][idx] = NULL;
+	while ((t = list)) {
+		list = t->next;
+		timer_link(t);
+	}
+
+	return idx;
+}
+
+/* advances the wheel up to the current time and calls the expired timers'
+ * callbacks */
+static void timer_run(void)
+{
+	unsigned long long now = timer_clock();
+
+	while (ctx->timer_num && ctx->timer_now < now) {
+		event_timer_t *t, **slot;
+		int level;
+
+		ctx->timer_now++;
+		for (level = 1; level < TIMER_WHEEL_LEVELS &&
+			!((ctx->timer_now >> TIMER_WHEEL_SHIFT(level - 1)) &
+			TIMER_WHEEL_MASK) && !timer_cascade(level); level++);
+
+		/* callbacks may add timers to this very slot, only the ones
+		 * due by now are expired */
+		slot = &ctx->timer_wheel[0][ctx->timer_now & TIMER_WHEEL_MASK];
+		for (t = *slot; t; ) {
+			event_timer_t timer = *t;
+
+			if (t->expires > ctx->timer_now) {
+				t = t->next;
+				continue;
+			}
+
+			timer_unlink(t);
+			pool_free(&ctx->pools[EVENT_POOL_TIMER], t);
+			ctx->timer_num--;
+			event_call(timer.func, timer.data);
+			t = *slot;
+		}
+	}
+
+	if (!ctx->timer_num)
+		ctx->timer_now = now;
+}
+
+/* the soonest tick at which the wheel may have work to do: either a timer
+ * expiring or a slot due for cascading */
+static unsigned long long timer_next(void)
+{
+	unsigned long long next = ctx->timer_now + TIMER_DELTA_MAX;
+	int level;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		unsigned long long base =
+			ctx->timer_now >> TIMER_WHEEL_SHIFT(level);
+		int i;
+
+		for (i = 1; i <= TIMER_WHEEL_SZ; i++) {
+			if (!ctx->timer_wheel[level][(base + i) &
+				TIMER_WHEEL_MASK]) {
+				continue;
+			}
+
+			next = MIN(next, (base + i) << TIMER_WHEEL_SHIFT(level));
+			break;
+		}
+	}
+
+	return next;
+}
+
+static void timer_wheel_clean(void)
+{
+	int level, idx;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		for (idx = 0; idx < TIMER_WHEEL_SZ; idx++) {
+			event_timer_t *t;
+
+			while ((t = ctx->timer_wheel[level][idx])) {
+				timer_unlink(t);
+				pool_free(&ctx->pools[EVENT_POOL_TIMER], t);
+			}
+		}
+	}
+
+	ctx->timer_num = 0;
 }
 
-static fd_set *fd_set_choose(int type, fd_set *rfd, fd_set *wfd, fd_set *efd)
+/* calls func once at least usec microseconds have passed. like fd callbacks,
+ * timer callbacks are called between generations */
+int event_add_timer(event_func_t func, void *data, unsigned long usec)
+{
+	unsigned long long now, expires;
+	event_timer_t *t;
+
+	EVENT_CTX_ASSERT();
+	if (!usec)
+		return event_add(func, data);
+
+	if (!(t = pool_alloc(&ctx->pools[EVENT_POOL_TIMER])))
+		return -1;
+
+	/* round the expiry up to a tick boundary so the timer never fires
+	 * early. an idle wheel is simply moved forward, otherwise it keeps its
+	 * position and the timer is filed relative to it */
+	now = timer_clock_usec();
+	expires = (now + usec + TIMER_TICK_USEC - 1) / TIMER_TICK_USEC;
+	if (!ctx->timer_num)
+		ctx->timer_now = now / TIMER_TICK_USEC;
+
+	t->expires = MIN(expires, ctx->timer_now + TIMER_DELTA_MAX);
+	t->func = func;
+	t->data = data;
+	timer_link(t);
+	ctx->timer_num++;
+	return 0;
+}
+
+/* cancels all pending timers of data */
+void event_del_timer(void *data)
+{
+	int level, idx;
+
+	EVENT_CTX_ASSERT();
+	for (level = 0; level < TIMER_WHEEL_LEVELS && ctx->timer_num; level++) {
+		for (idx = 0; idx < TIMER_WHEEL_SZ; idx++) {
+			event_timer_t *t = ctx->timer_wheel[level][idx];
+
+			while (t) {
+				event_timer_t *tmp = t;
+
+				t = t->next;
+				if (tmp->data != data)
+					continue;
+
+				timer_unlink(tmp);
+				pool_free(&ctx->pools[EVENT_POOL_TIMER], tmp);
+				ctx->timer_num--;
+			}
+		}
+	}
+}
+
+static unsigned int fd_type2epoll(int type)
 {
 	switch (type)
 	{
 	case FD_READ:
-		return rfd;
+		return EPOLLIN;
 	case FD_WRITE:
-		return wfd;
+		return EPOLLOUT;
 	case FD_EXCEPTION:
-		return efd;
+		return EPOLLPRI;
 	default:
-		return NULL;
+		return 0;
+	}
+}
+
+/* an fd registered for reading or writing is also ready on hang up or error
+ * so its callback gets to see the condition */
+static int fd_is_ready(fd_t *efd, unsigned int revents)
+{
+	unsigned int mask = fd_type2epoll(efd->type);
+
+	if (efd->type != FD_EXCEPTION)
+		mask |= EPOLLERR | EPOLLHUP;
+	return revents & mask ? 1 : 0;
+}
+
+/* re-registers fd with the union of the conditions its entries wait on */
+static int fd_epoll_update(int fd)
+{
+	struct epoll_event ev;
+	fd_t *efd;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.data.fd = fd;
+	for (efd = ctx->fd_list; efd && efd->fd <= fd; efd = efd->next) {
+		if (efd->fd == fd)
+			ev.events |= fd_type2epoll(efd->type);
 	}
+
+	if (!ev.events) {
+		epoll_ctl(ctx->fd_epoll, EPOLL_CTL_DEL, fd, NULL);
+		return 0;
+	}
+
+	if (!epoll_ctl(ctx->fd_epoll, EPOLL_CTL_MOD, fd, &ev))
+		return 0;
+
+	return errno == ENOENT ?
+		epoll_ctl(ctx->fd_epoll, EPOLL_CTL_ADD, fd, &ev) : -1;
+}
+
+static void fd_unlink(fd_t **efdp)
+{
+	fd_t *efd = *efdp;
+
+	*efdp = efd->next;
+	fd_epoll_update(efd->fd);
 }
 
 static void fd_list_clean(void)
 {
 	fd_t *tmp;
 
-	while ((tmp = fd_list)) {
-		fd_list = fd_list->next;
+	while ((tmp = ctx->fd_list)) {
+		ctx->fd_list = ctx->fd_list->next;
 		free_fd_t(tmp);
 	}
+
+	if (ctx->fd_epoll != -1) {
+		close(ctx->fd_epoll);
+		ctx->fd_epoll = -1;
+	}
 }
 
 static int fd_equal(fd_t *efd, int fd, int type, fd_func_t func, void *data)
@@ -218,140 +1013,171 @@ static int fd_equal(fd_t *efd, int fd, int type, fd_func_t func, void *data)
 int fd_add(int fd, int type, fd_func_t func, void *data)
 {
 	fd_t *efd, **eptr;
-	fd_set *fds;
 
+	EVENT_CTX_ASSERT();
 	if (type != FD_READ && type != FD_WRITE && type != FD_EXCEPTION) {
-		if (((type & FD_READ) && fd_add(fd, FD_READ, func, data)) ||
-			((type & FD_WRITE) &&
-			fd_add(fd, FD_WRITE, func, data)) ||
-			((type & FD_EXCEPTION) &&
-			fd_add(fd, FD_EXCEPTION, func, data))) {
-			fd_max = 0;
-			for (eptr = &fd_list; *eptr; eptr = &(*eptr)->next) {
-				if ((*eptr)->fd == fd) {
-					efd = *eptr;
-					*eptr = (*eptr)->next;
-					free_fd_t(efd);
-				}
-				fd_max = MAX((*eptr)->fd, fd);
-			}
+		if ((type & FD_READ) && fd_add(fd, FD_READ, func, data))
+			return -1;
+
+		if ((type & FD_WRITE) && fd_add(fd, FD_WRITE, func, data)) {
+			fd_del(fd, FD_READ, func, data);
 			return -1;
 		}
+
 		return 0;
 	}
 
-	/* TODO if (!(efd = fd_find(fd, type, func, data)) && ...)*/
-	if (!(efd = alloc_fd_t(fd, type, func, data)))
-		return -1;
-
-	if (!(fds = fd_set_choose(type, &fd_read, &fd_write, &fd_excep))) {
-		free_fd_t(efd);
+	if (ctx->fd_epoll == -1 &&
+		(ctx->fd_epoll = epoll_create1(EPOLL_CLOEXEC)) == -1) {
 		return -1;
 	}
 
-	fd_max = MAX(fd, fd_max);
-	if (!FD_ISSET(fd, fds))
-		FD_SET(fd, fds);
+	/* TODO if (!(efd = fd_find(fd, type, func, data)) && ...)*/
+	if (!(efd = alloc_fd_t(fd, type, func, data)))
+		return -1;
 
-	for (eptr = &fd_list; *eptr; eptr = &((*eptr)->next)) {
+	for (eptr = &ctx->fd_list; *eptr; eptr = &((*eptr)->next)) {
 		if (fd <= (*eptr)->fd)
 			break;
 	}
 
 	efd->next = *eptr;
 	*eptr = efd;
+
+	if (fd_epoll_update(fd)) {
+		fd_unlink(eptr);
+		free_fd_t(efd);
+		return -1;
+	}
+
 	return 0;
 }
 
 void fd_del(int fd, int type, fd_func_t func, void *data)
 {
 	fd_t **efdp, *efd;
-	fd_set *fds;
 
-	for (efdp = &fd_list; *efdp && !fd_equal(*efdp, fd, type, func, data);
+	EVENT_CTX_ASSERT();
+	for (efdp = &ctx->fd_list; *efdp &&
+		!fd_equal(*efdp, fd, type, func, data);
 		efdp = &((*efdp)->next));
 
 	if (!*efdp)
 		return;
 
 	efd = *efdp;
-	*efdp =(*efdp)->next;
-	fds = fd_set_choose(efd->type, &fd_read, &fd_write, &fd_excep);
-	FD_CLR(efd->fd, fds);
+	fd_unlink(efdp);
 	free_fd_t(efd);
 }
 
-static int fd_call(void)
+/* poll without blocking while there is work queued, otherwise sleep until an
+ * fd becomes ready or the next timer is due. returns milliseconds as expected
+ * by epoll_wait() */
+static int fd_wait_timeout(void)
 {
-#define TV_SEC 0
-#define TV_USEC 10
+	unsigned long long now, next;
+
+	if (ctx->event_live || ctx->signals)
+		return 0;
+
+	if (!ctx->timer_num)
+		return -1;
+
+	now = timer_clock();
+	if ((next = timer_next()) <= now)
+		return 0;
+
+	return (int)MIN((next - now) * TIMER_TICK_USEC / 1000, 0x7fffffff);
+}
 
+/* calls the callbacks of ready fds. callbacks are one-shot, and fds added
+ * during this generation are not called before the next one */
+static void fd_ready(int fd, unsigned int revents)
+{
 	fd_t **efdp;
-	fd_set fdr, fdw, fde;
-	struct timeval tv = {TV_SEC, TV_USEC};
-	int n, fds_copy_sz;
-
-	fds_copy_sz = MIN(fd_max / sizeof(char) + 1, sizeof(fd_set));
-	FD_ZERO(&fdr);
-	FD_ZERO(&fdw);
-	FD_ZERO(&fde);
-	memcpy(&fdr, &fd_read, fds_copy_sz);
-	memcpy(&fdw, &fd_write, fds_copy_sz);
-	memcpy(&fde, &fd_excep, fds_copy_sz);
-
-	if ((n = select(fd_max + 1, &fdr, &fdw, &fde, &tv)) <= 0)
-		return n;
-
-	for (efdp = &fd_list; *efdp; efdp = &((*efdp)->next)) {
-		fd_t *efd;
-		fd_set *fds;
-
-		if (!(fds = fd_set_choose((*efdp)->type, &fd_read, &fd_write,
-			&fd_excep))) {
-			return -1;
-		}
 
-		if (!FD_ISSET((*efdp)->fd, fds) ||
-			((*efdp)->stamp == stamp_now)) {
+	for (efdp = &ctx->fd_list; *efdp && (*efdp)->fd <= fd; ) {
+		fd_t *efd = *efdp;
+
+		if (efd->fd != fd || efd->stamp == ctx->stamp_now ||
+			!fd_is_ready(efd, revents)) {
+			efdp = &efd->next;
 			continue;
 		}
 
-		efd = *efdp;
-		*efdp = (*efdp)->next;
+		fd_unlink(efdp);
 		efd->func(efd->fd, efd->data);
 		free_fd_t(efd);
-	}
-	return 0;
 
-#undef TV_SEC
-#undef TV_USEC
+		/* the callback may have changed the list, start over */
+		efdp = &ctx->fd_list;
+	}
 }
 
-static event_status_t event_loop_once(void)
+static int fd_call(void)
 {
-	event_t **eptr = &event_list;
+	struct epoll_event evs[FD_EPOLL_EVENTS];
+	int i, n, timeout;
 
-	signal_calls();
-	stamp_now++;
-	while (*eptr) {
-		event_t *etmp, event;
+	if (!ctx->fd_list) {
+		/* no registered fds, only sleep if waiting on a timer */
+		if (!ctx->timer_num || !(timeout = fd_wait_timeout()))
+			return 0;
 
-		if ((*eptr)->stamp == stamp_now) {
-			eptr = &((*eptr)->next);
-			continue;
-		}
+		return poll(NULL, 0, timeout) < 0 && errno != EINTR ? -1 : 0;
+	}
+
+	if ((n = epoll_wait(ctx->fd_epoll, evs, FD_EPOLL_EVENTS,
+		fd_wait_timeout())) < 0) {
+		return errno == EINTR ? 0 : -1;
+	}
+
+	for (i = 0; i < n; i++)
+		fd_ready(evs[i].data.fd, evs[i].events);
+	return 0;
+}
+
+static void event_dispatch(event_entry_t *entry)
+{
+	event_t *e = event_find(entry->func, entry->data);
+	int is_cancelled = 0;
 
-		etmp = *eptr;
-		*eptr = (*eptr)->next;
-		if (event_list_tail == &etmp->next)
-			event_list_tail = eptr;
-		event = *etmp;
-		free_event_t(etmp);
-		event.func(event.data);
+	if (e->cancelled) {
+		e->cancelled--;
+		is_cancelled = 1;
 	}
+	e->pending--;
+	event_put(e);
 
-	if (!event_list && !fd_list && !signals)
+	if (is_cancelled)
+		return;
+
+	ctx->event_live--;
+	event_call(entry->func, entry->data);
+}
+
+static event_status_t event_loop_once(void)
+{
+	event_ring_t *ring;
+	event_entry_t entry;
+
+	timer_run();
+	signal_calls();
+	ctx->stamp_now++;
+
+	/* events queued up to now make up this generation, events added while
+	 * dispatching it go to the next one */
+	ring = ctx->event_ring_now;
+	ctx->event_ring_now = ctx->event_ring_next;
+	ctx->event_ring_next = ring;
+	while (!event_ring_pop(ctx->event_ring_now, &entry))
+		event_dispatch(&entry);
+
+	if (!ctx->event_live && !ctx->fd_list && !ctx->timer_num &&
+		!ctx->signals) {
+		event_queue_clear();
 		return EVENT_TERMINATE;
+	}
 	if (fd_call())
 		return EVENT_ERROR;
 
@@ -361,8 +1187,8 @@ static event_status_t event_loop_once(void)
 int event_loop(void)
 {
 	event_status_t res = EVENT_CONTINUE;
-	event_t *e;
 
+	EVENT_CTX_ASSERT();
 	while (res == EVENT_CONTINUE) {
 		if ((res = event_loop_once()) == EVENT_ERROR)
 			goto Error;
@@ -370,21 +1196,84 @@ int event_loop(void)
 	return 0;
 
 Error:
-	while ((e = event_list)) {
-		event_list = event_list->next;
-		free_event_t(e);
-	}
+	event_queue_clear();
 	return -1;
 }
 
-void event_init(void)
+event_ctx_t *event_ctx_new(void)
 {
-	event_list_tail = &event_list;
+	event_ctx_t *c;
+
+	if (!(c = calloc(1, sizeof(event_ctx_t))))
+		return NULL;
+
+	c->event_ring_now = &c->event_rings[0];
+	c->event_ring_next = &c->event_rings[1];
+	c->fd_epoll = -1;
+	c->pools[EVENT_POOL_EVENT].node_sz = sizeof(event_t);
+	c->pools[EVENT_POOL_FD].node_sz = sizeof(fd_t);
+	c->pools[EVENT_POOL_SIG].node_sz = sizeof(sig_table_t);
+	c->pools[EVENT_POOL_TIMER].node_sz = sizeof(event_timer_t);
+	return c;
 }
 
-void event_uninit(void)
+void event_ctx_free(event_ctx_t *c)
 {
+	event_ctx_t *prev = event_ctx_set(c);
+	event_pool_t pool;
+
 	signal_table_clean();
 	fd_list_clean();
+	timer_wheel_clean();
+	event_queue_clear();
+	event_hash_uninit();
+	event_ring_uninit(&ctx->event_rings[0]);
+	event_ring_uninit(&ctx->event_rings[1]);
+	for (pool = 0; pool < EVENT_POOL_COUNT; pool++)
+		pool_uninit(&ctx->pools[pool]);
+#ifdef EVENT_PROFILE
+	free(ctx->profile_hash);
+#endif
+
+	event_ctx_set(prev == c ? NULL : prev);
+	free(c);
+}
+
+/* makes c the calling thread's event loop, returns the one it replaces */
+event_ctx_t *event_ctx_set(event_ctx_t *c)
+{
+	event_ctx_t *prev = ctx;
+
+	ctx = c;
+	return prev;
+}
+
+event_ctx_t *event_ctx_get(void)
+{
+	return ctx;
+}
+
+void event_pool_stat_get(event_pool_t pool, event_pool_stat_t *stat)
+{
+	EVENT_CTX_ASSERT();
+	*stat = ctx->pools[pool].stat;
 }
 
+/* event_init() and event_uninit() provide the calling thread with a loop of
+ * its own for the duration of a single run */
+int event_init(void)
+{
+	event_ctx_t *c;
+
+	if (!(c = event_ctx_new()))
+		return -1;
+
+	event_ctx_set(c);
+	return 0;
+}
+
+void event_uninit(void)
+{
+	if (ctx)
+		event_ctx_free(ctx);
+}
@@ -15,6 +15,20 @@ typedef enum {
 	SIG_COUNT = 2,
 } sig_t;
 
+typedef enum {
+	EVENT_POOL_EVENT = 0,
+	EVENT_POOL_FD = 1,
+	EVENT_POOL_SIG = 2,
+	EVENT_POOL_TIMER = 3,
+	EVENT_POOL_COUNT = 4,
+} event_pool_t;
+
+typedef struct event_pool_stat_t {
+	unsigned long in_use;
+	unsigned long high_water;
+	unsigned long slabs;
+} event_pool_stat_t;
+
 typedef void (*event_func_t)(void *o);
 typedef void (*sig_func_t)(sig_t s, void *o);
 typedef void (*fd_func_t)(int fd, void *o);
@@ -35,25 +49,74 @@ typedef struct fd_t {
 	void *data;
 } fd_t;
 
+typedef struct event_timer_t {
+	struct event_timer_t *next;
+	struct event_timer_t **pprev;
+	unsigned long long expires;
+	event_func_t func;
+	void *data;
+} event_timer_t;
+
+/* pending events index entry: the number of queued (func, data) events and
+ * how many of them were deleted */
 typedef struct event_t {
-	struct event_t *next;
-	int stamp;
+	struct event_t *hnext;
+	struct event_t **hpprev;
 	event_func_t func;
 	void *data;
+	int pending;
+	int cancelled;
+	int scan;
 } event_t;
 
 typedef void (*e_funct_t)(void *);
 
+typedef struct event_ctx_t event_ctx_t;
+
+#ifdef EVENT_PROFILE
+typedef struct event_profile_sym_t {
+	event_func_t func;
+	char *name;
+} event_profile_sym_t;
+
+#define EVENT_PROFILE_START(table) \
+	static event_profile_sym_t table[] = {
+#define EVENT_PROFILE_ENTRY(func) \
+	{ func, #func },
+#define EVENT_PROFILE_END \
+	{ NULL, NULL } \
+	};
+#define EVENT_PROFILE_REGISTER(table) \
+	event_profile_register(table)
+
+void event_profile_register(event_profile_sym_t *syms);
+void event_profile_report(void);
+#else
+#define EVENT_PROFILE_START(table)
+#define EVENT_PROFILE_ENTRY(func)
+#define EVENT_PROFILE_END
+#define EVENT_PROFILE_REGISTER(table) do {} while (0)
+#define event_profile_report() do {} while (0)
+#endif
+
 int signal_register(sig_t signal, sig_func_t func, void *data);
 void signal_set(sig_t signal);
 int event_add(event_func_t func, void *data);
 int event_add_once(event_func_t func, void *data);
 void event_del_once(void *data);
 void event_del_all(void *data);
+int event_is_pending(void *data);
+int event_add_timer(event_func_t func, void *data, unsigned long usec);
+void event_del_timer(void *data);
 int fd_add(int fd, int type, fd_func_t func, void *data);
 void fd_del(int fd, int type, fd_func_t func, void *data);
 int event_loop(void);
-void event_init(void);
+void event_pool_stat_get(event_pool_t pool, event_pool_stat_t *stat);
+event_ctx_t *event_ctx_new(void);
+void event_ctx_free(event_ctx_t *c);
+event_ctx_t *event_ctx_set(event_ctx_t *c);
+event_ctx_t *event_ctx_get(void);
+int event_init(void);
 void event_uninit(void);
 
 #endif
@@ -4,10 +4,18 @@
 #include "sat_variable.h"
 #include "sat_table.h"
 #include "sat_parser.h"
+#include "sat_dimacs.h"
+#include "sat_preprocess.h"
+#include "sat_component.h"
+#include "sat_count.h"
 #include "sat_ca.h"
+#include "sat_batch.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #define ASSERT_INPUT(arg, map) do { \
 	if (ICP(arg) & map) { \
@@ -26,13 +34,24 @@
 	map |= FLG(arg); \
 } while (0)
 
+/* -j given alongside an expression rather than a batch is missing its -B */
+#define ASSERT_BATCH_JOBS(map) do { \
+	if (((map) & (FLG(BATCH_JOBS) | FLG(INPUT_BATCH))) == \
+		FLG(BATCH_JOBS)) { \
+		fprintf(stderr, "option -%c requires option -%c\n", \
+			OPT(BATCH_JOBS), OPT(INPUT_BATCH)); \
+		return -1; \
+	} \
+} while (0)
+
 #define ASSERT_INPUT_SOURCE(arg, map) do { \
+	ASSERT_BATCH_JOBS(map); \
 	if ((FLG(arg) | ICP(arg)) & map) { \
 		fprintf(stderr, "only one CNF expression must be specified\n");\
 			return -1; \
 	} \
-	if (!(sat.cs = cs_open(IDX(arg) == IDX(INPUT_STRING) ? \
-		CS_STRING2CHAR : CS_FILE2CHAR, optarg))) { \
+	if (!(input->cs = cs_open(IDX(arg) == IDX(INPUT_STRING) ? \
+		CS_STRING2CHAR : cs_file_type(optarg), optarg))) { \
 		fprintf(stderr, "could not open character stream for %s\n", \
 			optarg); \
 		return -1; \
@@ -42,51 +61,221 @@
 
 #define MICRO_DEVIDOR 1000000
 
+/* what the command line asks to be solved */
+typedef struct sat_input_t {
+	cs_t *cs;
+	char *batch;
+	int jobs;
+	int assignment_max;
+	int is_count;
+	int is_sync;
+	int sync_threads;
+	int is_stats;
+} sat_input_t;
+
 typedef enum sat_error_t {
 	SAT_ERR_PARSE = 0,
 	SAT_ERR_POS_TABLE = 1,
 	SAT_ERR_DO_SAT = 2,
+	SAT_ERR_PREPROCESS = 3,
 } sat_error_t;
 
-typedef struct sat_t {
+/* everything a single solver run owns. runs sharing nothing but the code can
+ * be carried out concurrently, each on a thread of its own */
+struct sat_ctx_t {
+	event_ctx_t *event;
+	parser_t parser;
 	parser_cb_t parser_cb;
-	ca_space_cb_t space;
 	cs_t *cs;
 	variable_t *variables;
-	clause_t *clauses;
-	table_t *table;
+	clauses_t *clauses;
+	int var_num;
+	preprocess_t pre;
+	components_t comps;
+	int free_num;
+	sat_tv_t *reduced;
+	literal_t *assignment;
+	long long assignment_num;
+	int assignment_max;
+	int is_count;
+	int is_sync;
+	int sync_threads;
+	int tile_cells_min;
+	int is_stats;
+	int jobs;
 	sat_print_field_t print_field;
 	sat_print_speed_t print_speed;
+	FILE *out;
 	int errno;
-} sat_t;
-
-void sat_print_results(table_t *table, variable_t *variables);
-static sat_t sat;
+	int ret;
+};
+
+/* a component solved by a CA space on an event loop of its own */
+typedef struct sat_solve_t {
+	ca_space_t space;
+	ca_space_cb_t space_cb;
+	int ret;
+} sat_solve_t;
+
+/* the components of an expression being solved by a pool of threads */
+typedef struct sat_pool_t {
+	sat_ctx_t *s;
+	int next;
+	int ret;
+	pthread_mutex_t lock;
+} sat_pool_t;
+
+void sat_print_result(FILE *out, int is_satisfyable);
+void sat_print_count(FILE *out, count_t *count);
+void sat_print_assignment(FILE *out, long long idx, literal_t *assignment,
+	int var_num, variable_t *variables);
+static void sat_error(void *o);
 
 static void sat_uninit(void *o)
 {
-	sat_t *s = (sat_t *)o;
+	sat_ctx_t *s = (sat_ctx_t *)o;
 
 	variables_clr(&(s->variables));
+	preprocess_clr(&s->pre);
+	components_clr(&s->comps);
+	free(s->reduced);
+	s->reduced = NULL;
+	free(s->assignment);
+	s->assignment = NULL;
+}
+
+/* as many assignments as were asked for have been printed */
+static int sat_is_assignment_max(sat_ctx_t *s)
+{
+	return s->assignment_max && s->assignment_num >= s->assignment_max;
+}
+
+/* prints the assignments of the expression that extend the reduced one in
+ * s->reduced, one per combination of the free variables. with too many free
+ * variables to go through, only as many combinations as were asked for are */
+static void sat_assignments_print(sat_ctx_t *s)
+{
+	int i, num;
+
+	if (!s->assignment_num)
+		sat_print_result(s->out, 1);
+
+	num = s->free_num < (int)sizeof(int) * 8 - 1 ? 1 << s->free_num :
+		s->assignment_max;
+	for (i = 0; i < num && !sat_is_assignment_max(s); i++) {
+		preprocess_assignment_get(&s->pre, s->reduced, i, s->assignment);
+		sat_print_assignment(s->out, s->assignment_num++, s->assignment,
+			s->pre.var_num, s->variables);
+	}
+}
+
+/* a single component's assignments are printed as soon as the CA finds
+ * them */
+static void sat_assignment_cb(void *data, table_t *table, int idx)
+{
+	sat_ctx_t *s = (sat_ctx_t *)data;
+
+	component_assignment_get(&s->comps.comps[0], idx, s->reduced);
+	sat_assignments_print(s);
+	fflush(s->out);
+}
+
+/* the number of the components' combined assignments, or -1 if there are
+ * too many to go through. when only some are asked for, the free variables
+ * need not be gone through in full */
+static long long sat_assignment_num(sat_ctx_t *s)
+{
+	long long num;
+
+	if (s->pre.is_unsat)
+		return 0;
+
+	if ((num = s->comps.num ? components_assignment_num(&s->comps) : 1) < 0 ||
+		(!s->assignment_max && num > LLONG_MAX >> s->free_num)) {
+		return -1;
+	}
+
+	return num;
+}
+
+/* the number of assignments is the product of the components' counts, times
+ * two for each free variable */
+static int sat_count(sat_ctx_t *s, count_t *count)
+{
+	int i;
+
+	if (count_set(count, !s->pre.is_unsat))
+		return -1;
+
+	for (i = 0; i < s->comps.num; i++) {
+		if (count_mul(count, s->comps.comps[i].count))
+			return -1;
+	}
+
+	return count_shl(count, s->free_num);
 }
 
+static void sat_count_success(void *o)
+{
+	sat_ctx_t *s = (sat_ctx_t *)o;
+	count_t count = { 0 };
+
+	if (sat_count(s, &count)) {
+		count_clr(&count);
+		fprintf(s->out, "could not count the assignments\n");
+		s->errno = SAT_ERR_DO_SAT;
+		event_add(sat_error, o);
+		return;
+	}
+
+	sat_print_result(s->out, !count_is_zero(&count));
+	sat_print_count(s->out, &count);
+	fflush(s->out);
+
+	s->ret = count_int_get(&count);
+	count_clr(&count);
+	event_add(sat_uninit, o);
+}
+
+/* the assignments of several components are the cross product of theirs.
+ * they are put together one at a time as they are printed */
 static void sat_success(void *o)
 {
-	sat_t *s = (sat_t *)o;
+	sat_ctx_t *s = (sat_ctx_t *)o;
+	long long i, num;
+
+	if (s->comps.num != 1) {
+		if ((num = sat_assignment_num(s)) < 0) {
+			fprintf(s->out, "could not expand the assignments\n");
+			s->errno = SAT_ERR_DO_SAT;
+			event_add(sat_error, o);
+			return;
+		}
+
+		for (i = 0; i < num && !sat_is_assignment_max(s); i++) {
+			components_assignment_get(&s->comps, i, s->reduced);
+			sat_assignments_print(s);
+		}
+	}
+
+	if (!s->assignment_num)
+		sat_print_result(s->out, 0);
+	fflush(s->out);
 
-	sat_print_results(s->table, s->variables);
-	table_clr(s->table);
+	s->ret = s->assignment_num > INT_MAX ? INT_MAX : s->assignment_num;
 	event_add(sat_uninit, o);
 }
 
 static void sat_error(void *o)
 {
-	sat_t *s = (sat_t *)o;
+	sat_ctx_t *s = (sat_ctx_t *)o;
 
 	switch (s->errno)
 	{
 	case SAT_ERR_PARSE:
+	case SAT_ERR_PREPROCESS:
 		cs_close(s->cs);
+		s->cs = NULL;
 		clause_clr(&(s->clauses));
 		break;
 	case SAT_ERR_POS_TABLE:
@@ -98,102 +287,365 @@ static void sat_error(void *o)
 	event_add(sat_uninit, o);
 }
 
-static void sat_clause_new(sat_t *s)
+static void sat_clause_new_cb(void *data)
 {
-	static sat_t *sat;
+	sat_ctx_t *s = (sat_ctx_t *)data;
 
-	if (!sat) {
-		sat = s;
-		return;
-	}
+	clause_new(&(s->clauses));
+}
+
+static int sat_literal_new_cb(void *data, char *name, int val)
+{
+	sat_ctx_t *s = (sat_ctx_t *)data;
 
-	clause_new(&(sat->clauses));
+	return clause_add(s->clauses, name, val, &(s->variables));
 }
 
-static void sat_clause_new_init(sat_t *s)
+static void sat_solve_success(void *o)
 {
-	sat_clause_new(s);
+	((sat_solve_t *)o)->ret = 0;
 }
 
-static void sat_clause_new_cb(void)
+static void sat_solve_fail(void *o)
 {
-	sat_clause_new(NULL);
+	((sat_solve_t *)o)->ret = -1;
 }
 
-static int sat_literal_new(sat_t *s, char *name, int val)
+EVENT_PROFILE_START(sat_solve_profile_syms)
+	EVENT_PROFILE_ENTRY(sat_solve_success)
+	EVENT_PROFILE_ENTRY(sat_solve_fail)
+EVENT_PROFILE_END
+
+/* runs the CA on a component to completion, on the calling thread. a
+ * streamed component has its assignments printed as they are found. the CA
+ * need not find more assignments than are to be printed */
+static int sat_component_solve(sat_ctx_t *s, component_t *comp,
+	int is_stream)
 {
-	static sat_t *sat;
+	event_ctx_t *event, *prev;
+	sat_solve_t *sv;
+	int ret = -1;
 
-	if (!sat) {
-		sat = s;
-		return 0;
+	if (!(comp->table = table_create(comp->clauses, comp->var_num)))
+		return -1;
+	clause_clr(&comp->clauses);
+
+	if (!(sv = calloc(1, sizeof(sat_solve_t))))
+		return -1;
+
+	if (!(event = event_ctx_new())) {
+		free(sv);
+		return -1;
 	}
 
-	return clause_add(sat->clauses, name, val, &(sat->variables));
+	sv->space_cb.table = comp->table;
+	sv->space_cb.success_cb = sat_solve_success;
+	sv->space_cb.success_data = sv;
+	sv->space_cb.fail_cb = sat_solve_fail;
+	sv->space_cb.fail_data = sv;
+	sv->space_cb.assignment_cb = is_stream && !s->is_count ?
+		sat_assignment_cb : NULL;
+	sv->space_cb.assignment_data = s;
+	sv->space_cb.assignment_max = s->assignment_max;
+	sv->space_cb.is_count = s->is_count;
+	sv->space_cb.is_sync = s->is_sync;
+	sv->space_cb.sync_threads = s->sync_threads;
+	sv->space_cb.tile_cells_min = s->tile_cells_min;
+	sv->space_cb.is_stats = s->is_stats;
+	sv->ret = -1;
+
+	prev = event_ctx_set(event);
+	EVENT_PROFILE_REGISTER(sat_solve_profile_syms);
+	sp_init(&sv->space, &sv->space_cb, comp->table, s->print_field,
+		s->print_speed);
+	if (!event_loop())
+		ret = sv->ret;
+	comp->count = sv->space.success_num;
+	event_profile_report();
+	event_ctx_set(prev);
+
+	event_ctx_free(event);
+	free(sv);
+	return ret;
 }
 
-static void sat_literal_new_init(sat_t *s)
+static void *sat_component_worker(void *o)
 {
-	sat_literal_new(s, NULL, 0);
+	sat_pool_t *pool = (sat_pool_t *)o;
+	components_t *comps = &pool->s->comps;
+
+	while (1) {
+		int idx, ret;
+
+		pthread_mutex_lock(&pool->lock);
+		idx = pool->ret ? comps->num : pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+
+		if (idx >= comps->num)
+			break;
+
+		ret = sat_component_solve(pool->s, &comps->comps[idx], 0);
+
+		pthread_mutex_lock(&pool->lock);
+		pool->ret |= ret;
+		pthread_mutex_unlock(&pool->lock);
+	}
+
+	return NULL;
 }
 
-static int sat_literal_new_cb(char *name, int val)
+/* solves the components, each in a CA space of its own, on as many threads
+ * as there are components or s->jobs, whichever is fewer. s->jobs <= 0
+ * stands for one thread per online processor */
+static int sat_components_solve(sat_ctx_t *s)
 {
-	return sat_literal_new(NULL, name, val);
+	sat_pool_t pool = { s, 0, 0 };
+	pthread_t *workers;
+	int i, jobs = s->jobs;
+
+	if (s->comps.num == 1)
+		return sat_component_solve(s, &s->comps.comps[0], 1);
+
+	if (jobs <= 0 && (jobs = sysconf(_SC_NPROCESSORS_ONLN)) <= 0)
+		jobs = 1;
+	if (jobs > s->comps.num)
+		jobs = s->comps.num;
+
+	if (!(workers = calloc(jobs, sizeof(pthread_t))))
+		return -1;
+
+	pthread_mutex_init(&pool.lock, NULL);
+	for (i = 0; i < jobs && !pthread_create(&workers[i], NULL,
+		sat_component_worker, &pool); i++);
+
+	/* should no worker start, the calling thread does the work itself */
+	if (!i)
+		sat_component_worker(&pool);
+	while (i--)
+		pthread_join(workers[i], NULL);
+	pthread_mutex_destroy(&pool.lock);
+	free(workers);
+
+	return pool.ret;
 }
 
-static void sat_do(void *o)
+static void sat_components(void *o)
 {
-	sat_t *s = (sat_t *)o;
+	sat_ctx_t *s = (sat_ctx_t *)o;
 
-	s->space.table = s->table;
-	s->space.success_cb = sat_success;
-	s->space.success_data = s;
-	s->space.fail_cb = sat_error;
-	s->space.fail_data = s;
+	cs_close(s->cs);
+	s->cs = NULL;
+
+	/* each free variable doubles the number of assignments, which can
+	 * always be counted, and always be listed up to a maximum, but not
+	 * always listed in full */
+	s->free_num = preprocess_free_num(&s->pre);
+	if (!s->pre.is_unsat && !s->is_count && !s->assignment_max &&
+		s->free_num >= (int)sizeof(int) * 8 - 1) {
+		fprintf(s->out, "too many assignments\n");
+		s->errno = SAT_ERR_DO_SAT;
+		clause_clr(&s->clauses);
+		event_add(sat_error, o);
+		return;
+	}
+
+	s->errno = SAT_ERR_POS_TABLE;
+	if (!(s->reduced = calloc(s->pre.reduced_num + 1, sizeof(sat_tv_t))) ||
+		!(s->assignment = calloc(s->pre.var_num + 1,
+		sizeof(literal_t)))) {
+		clause_clr(&s->clauses);
+		event_add(sat_error, o);
+		return;
+	}
+
+	/* the graphical display shows a single CA space, do not split */
+	if (components_split(&s->comps, s->clauses, s->pre.reduced_num,
+		s->print_field == SAT_PRINT_FIELD_NONE)) {
+		clause_clr(&s->clauses);
+		event_add(sat_error, o);
+		return;
+	}
+	clause_clr(&s->clauses);
+
+	/* with no clauses left, preprocessing has either satisfied every clause
+	 * or found a contradiction and there is nothing for the CA to solve */
 	s->errno = SAT_ERR_DO_SAT;
+	if (s->comps.num && sat_components_solve(s)) {
+		event_add(sat_error, o);
+		return;
+	}
 
-	sp_init(&s->space, s->table, s->print_field, s->print_speed);
+	event_add(s->is_count ? sat_count_success : sat_success, o);
 }
 
-static void sat_table_create(void *o)
+static void sat_preprocess(void *o)
 {
-	sat_t *s = (sat_t *)o;
-	event_func_t next_cb;
-	variable_t *var;
-	int var_num;
+	sat_ctx_t *s = (sat_ctx_t *)o;
+
+	/* DIMACS input has its variable count set by the problem line */
+	if (s->variables)
+		s->var_num = variable_num_get(s->variables);
 
-	for (var = s->variables, var_num = 0; var; var = var->next, var_num++);
-	if (!(s->table = table_create(s->clauses, var_num))) {
-		s->errno = SAT_ERR_POS_TABLE;
-		next_cb = sat_error;
-		goto Exit;
+	/* pure literals may only go when a single assignment is looked for */
+	s->errno = SAT_ERR_PREPROCESS;
+	if (preprocess(&s->pre, &s->clauses, s->var_num,
+		s->assignment_max == 1 ? PRE_PURE_LITERALS : 0)) {
+		event_add(sat_error, o);
+		return;
 	}
 
-	next_cb = sat_do;
+	event_add(sat_components, o);
+}
 
-Exit:
-	cs_close(s->cs);
-	clause_clr(&s->clauses);
-	event_add(next_cb, o);
+static void sat_dimacs_parse(void *o)
+{
+	sat_ctx_t *s = (sat_ctx_t *)o;
+
+	s->errno = SAT_ERR_PARSE;
+	if (dimacs_read(s->cs, &s->clauses, &s->var_num, s->out)) {
+		event_add(sat_error, o);
+		return;
+	}
+
+	event_add(sat_preprocess, o);
 }
 
 static void sat_parse(void *o)
 {
-	sat_t *s = (sat_t *)o;
+	sat_ctx_t *s = (sat_ctx_t *)o;
 
-	sat_clause_new_init(s);
-	sat_literal_new_init(s);
+	if (dimacs_is(s->cs)) {
+		event_add(sat_dimacs_parse, o);
+		return;
+	}
 
 	s->parser_cb.clause_new = sat_clause_new_cb;
 	s->parser_cb.literal_new = sat_literal_new_cb;
-	s->parser_cb.success_cb = sat_table_create;
+	s->parser_cb.data = s;
+	s->parser_cb.success_cb = sat_preprocess;
 	s->parser_cb.success_data = s;
 	s->parser_cb.fail_cb = sat_error;
 	s->parser_cb.fail_data = s;
+	s->parser_cb.out = s->out;
 	s->errno = SAT_ERR_PARSE;
 
-	parser_init(&(s->parser_cb), s->cs);
+	parser_init(&(s->parser), &(s->parser_cb), s->cs);
+}
+
+EVENT_PROFILE_START(sat_profile_syms)
+	EVENT_PROFILE_ENTRY(sat_uninit)
+	EVENT_PROFILE_ENTRY(sat_success)
+	EVENT_PROFILE_ENTRY(sat_count_success)
+	EVENT_PROFILE_ENTRY(sat_error)
+	EVENT_PROFILE_ENTRY(sat_components)
+	EVENT_PROFILE_ENTRY(sat_preprocess)
+	EVENT_PROFILE_ENTRY(sat_dimacs_parse)
+	EVENT_PROFILE_ENTRY(sat_parse)
+EVENT_PROFILE_END
+
+/* creates a solver for the CNF expression read from cs. the solver takes over
+ * the character stream */
+sat_ctx_t *sat_ctx_new(cs_t *cs)
+{
+	sat_ctx_t *s;
+
+	if (!(s = calloc(1, sizeof(sat_ctx_t))))
+		return NULL;
+
+	if (!(s->event = event_ctx_new())) {
+		free(s);
+		return NULL;
+	}
+
+	s->cs = cs;
+	s->print_field = SAT_PRINT_FIELD_NONE;
+	s->print_speed = SAT_PRINT_SPEED_MEDIUM;
+	s->out = stdout;
+	return s;
+}
+
+void sat_ctx_free(sat_ctx_t *s)
+{
+	if (s->cs)
+		cs_close(s->cs);
+	clause_clr(&s->clauses);
+	variables_clr(&s->variables);
+	preprocess_clr(&s->pre);
+	components_clr(&s->comps);
+	free(s->reduced);
+	free(s->assignment);
+	event_ctx_free(s->event);
+	free(s);
+}
+
+/* where the results, and the errors met reading or solving the expression,
+ * are written to, stdout by default */
+void sat_ctx_output_set(sat_ctx_t *s, FILE *out)
+{
+	s->out = out;
+}
+
+/* the run is over once max assignments have been found, 0 (the default)
+ * looks for all of them */
+void sat_ctx_assignment_max_set(sat_ctx_t *s, int max)
+{
+	s->assignment_max = max;
+}
+
+/* steps the CA a whole generation at a time from a pair of buffers, rather
+ * than writing each of its cells' fields by an event of its own */
+void sat_ctx_sync_set(sat_ctx_t *s, int is_sync)
+{
+	s->is_sync = is_sync;
+}
+
+/* a synchronous generation with enough cells due is split into tiles, each
+ * scanned on a thread of its own. the assignments found are the same, and
+ * are found in the same order, whatever the number of threads */
+void sat_ctx_sync_threads_set(sat_ctx_t *s, int threads)
+{
+	s->sync_threads = threads;
+}
+
+/* the fewest cells due per tile for a generation to be split into tiles, 0
+ * (the default) being as many as are worth a thread's while */
+void sat_ctx_tile_cells_min_set(sat_ctx_t *s, int cells)
+{
+	s->tile_cells_min = cells;
+}
+
+/* each CA space reports its number of generations and of active cells per
+ * generation, if stepped synchronously, and its peak number of blocks to
+ * stderr once it is done */
+void sat_ctx_stats_set(sat_ctx_t *s, int is_stats)
+{
+	s->is_stats = is_stats;
+}
+
+/* the number of threads the expression's independent components are solved
+ * on, 0 (the default) being one per online processor. runs sharing the
+ * processors with others are best given fewer */
+void sat_ctx_jobs_set(sat_ctx_t *s, int jobs)
+{
+	s->jobs = jobs;
+}
+
+/* runs the solver's event loop on the calling thread until the expression has
+ * been solved. returns the number of satisfying assignments found, or -1 on
+ * any error */
+int sat_ctx_run(sat_ctx_t *s)
+{
+	event_ctx_t *prev = event_ctx_set(s->event);
+	int ret;
+
+	s->ret = -1;
+	EVENT_PROFILE_REGISTER(sat_profile_syms);
+	event_add(sat_parse, s);
+	ret = event_loop();
+	event_profile_report();
+	event_ctx_set(prev);
+
+	return ret ? -1 : s->ret;
 }
 
 static sat_print_field_t opt_config_print_field(int opt)
@@ -238,11 +690,15 @@ static void sat_usage(char *app_name)
 		"  or\n"
 		"%s [ OPTIONS ] -%c <file_name>\n"
 		"  or\n"
+		"%s -%c <dir | list_file> [ -%c <jobs> ] [ -%c | -%c <num> ]\n"
+		"  or\n"
 		"%s -%c | -%c\n"
 		"\n"
 		"the predicate must be of the form: (p1 or -p2) and "
 		"(-p1 or p4 or p3) and (-p4)\n"
 		"where p1, p2, p3, p4, etc... are valid alphanumeric names\n"
+		"a predicate starting with a comment (c) or a problem line "
+		"(p cnf <variables> <clauses>) is read as DIMACS CNF\n"
 		"\n"
 		"OPTIONS (in each of the following categories the options are "
 		"not compatible with each other):\n"
@@ -265,6 +721,27 @@ static void sat_usage(char *app_name)
 		"  -%c: medium: %g seconds per iteration (default)\n"
 		"  -%c: rapid: %g seconds per iteration\n"
 		"\n"
+		"batch mode (no graphical display)\n"
+		"  -%c: solve every file in the specified directory, or every "
+		"file listed, one per line, in the specified file\n"
+		"  -%c: number of worker threads (default: number of online "
+		"processors)\n"
+		"\n"
+		"assignments to look for (default: all)\n"
+		"  -%c: stop at the first satisfying assignment\n"
+		"  -%c: stop after the specified number of satisfying "
+		"assignments\n"
+		"  -%c: only count the satisfying assignments (not in batch "
+		"mode)\n"
+		"\n"
+		"cellular automata engine\n"
+		"  -%c: step the cellular automata synchronously, a generation "
+		"at a time\n"
+		"  -%c: number of threads to step the cellular automata on "
+		"(requires -%c)\n"
+		"  -%c: print the cellular automata's generations, active cells "
+		"and blocks\n"
+		"\n"
 		"other options (these options are compatible with each other)\n"
 		"  -%c: print this message and exit\n"
 		"  -%c: clear screen and enable cursor in case of premature "
@@ -273,6 +750,8 @@ static void sat_usage(char *app_name)
 		"%c IAS, April 2006\n",
 		app_name, OPT(INPUT_STRING),
 		app_name, OPT(INPUT_FILE),
+		app_name, OPT(INPUT_BATCH), OPT(BATCH_JOBS), OPT(SOLVE_ONE),
+		OPT(SOLVE_NUM),
 		app_name, OPT(HELP), OPT(CURSOR),
 		OPT(INPUT_STRING), OPT(INPUT_FILE),
 		OPT(PRINT_NONE),
@@ -284,6 +763,11 @@ static void sat_usage(char *app_name)
 		OPT(PRINT_SLOW), (double)SPEED_SLOW/MICRO_DEVIDOR,
 		OPT(PRINT_MEDIUM), (double)SPEED_MEDIUM/MICRO_DEVIDOR,
 		OPT(PRINT_RAPID), (double)SPEED_RAPID/MICRO_DEVIDOR,
+		OPT(INPUT_BATCH), OPT(BATCH_JOBS),
+		OPT(SOLVE_ONE), OPT(SOLVE_NUM), OPT(SOLVE_COUNT),
+		OPT(ENGINE_SYNC),
+		OPT(ENGINE_THREADS), OPT(ENGINE_SYNC),
+		OPT(ENGINE_STATS),
 		OPT(HELP), OPT(CURSOR),
 		ASCII_COPYRIGHT);
 }
@@ -294,7 +778,7 @@ static void clear_cursor(void)
 	fflush(stdout);
 }
 
-static int opt_get(int argc, char **argv)
+static int opt_get(int argc, char **argv, sat_input_t *input)
 {
 	int opt_flags = 0;
 	char opt;
@@ -328,6 +812,43 @@ static int opt_get(int argc, char **argv)
 			ASSERT_INPUT_SOURCE(INPUT_STRING, opt_flags);
 		else if (opt == OPT(INPUT_FILE))
 			ASSERT_INPUT_SOURCE(INPUT_FILE, opt_flags);
+		else if (opt == OPT(INPUT_BATCH)) {
+			ASSERT_INPUT(INPUT_BATCH, opt_flags);
+			input->batch = optarg;
+		}
+		else if (opt == OPT(BATCH_JOBS)) {
+			if (opt_flags & (FLG(INPUT_STRING) | FLG(INPUT_FILE)))
+				ASSERT_BATCH_JOBS(opt_flags | FLG(BATCH_JOBS));
+			ASSERT_INPUT(BATCH_JOBS, opt_flags);
+			if ((input->jobs = atoi(optarg)) <= 0)
+				return -1;
+		}
+		else if (opt == OPT(SOLVE_ONE)) {
+			ASSERT_INPUT(SOLVE_ONE, opt_flags);
+			input->assignment_max = 1;
+		}
+		else if (opt == OPT(SOLVE_NUM)) {
+			ASSERT_INPUT(SOLVE_NUM, opt_flags);
+			if ((input->assignment_max = atoi(optarg)) <= 0)
+				return -1;
+		}
+		else if (opt == OPT(SOLVE_COUNT)) {
+			ASSERT_INPUT(SOLVE_COUNT, opt_flags);
+			input->is_count = 1;
+		}
+		else if (opt == OPT(ENGINE_SYNC)) {
+			ASSERT_INPUT(ENGINE_SYNC, opt_flags);
+			input->is_sync = 1;
+		}
+		else if (opt == OPT(ENGINE_THREADS)) {
+			ASSERT_INPUT(ENGINE_THREADS, opt_flags);
+			if ((input->sync_threads = atoi(optarg)) <= 0)
+				return -1;
+		}
+		else if (opt == OPT(ENGINE_STATS)) {
+			ASSERT_INPUT(ENGINE_STATS, opt_flags);
+			input->is_stats = 1;
+		}
 		else
 			return -1;
 	}
@@ -335,8 +856,11 @@ static int opt_get(int argc, char **argv)
 	return opt_flags ? opt_flags : -1;
 }
 
-static int opt_config(char *app_name, int opt_flags)
+static int opt_config(char *app_name, int opt_flags, sat_input_t *input)
 {
+	sat_ctx_t *s;
+	int ret;
+
 	if (opt_flags == -1) {
 		fprintf(stderr, "try %s -h for more information\n", app_name);
 		return -1;
@@ -349,17 +873,46 @@ static int opt_config(char *app_name, int opt_flags)
 			clear_cursor();
 	}
 
-	if (opt_flags & flags_input) {
-		sat.print_field = opt_config_print_field(opt_flags);
-		sat.print_speed = opt_config_print_speed(opt_flags);
-		event_add(sat_parse, &sat);
+	if ((opt_flags & FLG(ENGINE_THREADS)) &&
+		!(opt_flags & FLG(ENGINE_SYNC))) {
+		fprintf(stderr, "option -%c requires option -%c\n",
+			OPT(ENGINE_THREADS), OPT(ENGINE_SYNC));
+		return -1;
 	}
 
-	return 0;
+	if (opt_flags & flags_batch) {
+		ASSERT_BATCH_JOBS(opt_flags);
+
+		return sat_batch(input->batch, input->jobs,
+			input->assignment_max, input->is_sync,
+			input->sync_threads);
+	}
+
+	if (!(opt_flags & flags_input))
+		return 0;
+
+	if (!(s = sat_ctx_new(input->cs))) {
+		cs_close(input->cs);
+		return -1;
+	}
+
+	s->print_field = opt_config_print_field(opt_flags);
+	s->print_speed = opt_config_print_speed(opt_flags);
+	s->assignment_max = input->assignment_max;
+	s->is_count = input->is_count;
+	s->is_sync = input->is_sync;
+	s->sync_threads = input->sync_threads;
+	s->is_stats = input->is_stats;
+	ret = sat_ctx_run(s);
+	sat_ctx_free(s);
+	return ret < 0 ? -1 : 0;
 }
 
-int sat_init(int argc, char **argv)
+int sat_main(int argc, char **argv)
 {
-	return opt_config(argv[0], opt_get(argc, argv));
+	sat_input_t input = { NULL, NULL, 0, 0, 0, 0, 0, 0 };
+	int opt_flags = opt_get(argc, argv, &input);
+
+	return opt_config(argv[0], opt_flags, &input);
 }
 
@@ -1,6 +1,8 @@
 #ifndef _SAT_H_
 #define _SAT_H_
 
+#include <stdio.h>
+
 #define MAX_VARIABLE_SZ 256
 #define SAT_TV_INVERSE(val) ((SAT_TV_CNT + 1 - (val)) % SAT_TV_CNT)
 
@@ -51,7 +53,20 @@ typedef enum {
 	SAT_TV_CNT = 4
 } sat_tv_t;
 
-int sat_init(int argc, char **argv);
+struct cs_t;
+typedef struct sat_ctx_t sat_ctx_t;
+
+sat_ctx_t *sat_ctx_new(struct cs_t *cs);
+void sat_ctx_free(sat_ctx_t *s);
+void sat_ctx_output_set(sat_ctx_t *s, FILE *out);
+void sat_ctx_assignment_max_set(sat_ctx_t *s, int max);
+void sat_ctx_sync_set(sat_ctx_t *s, int is_sync);
+void sat_ctx_sync_threads_set(sat_ctx_t *s, int threads);
+void sat_ctx_tile_cells_min_set(sat_ctx_t *s, int cells);
+void sat_ctx_stats_set(sat_ctx_t *s, int is_stats);
+void sat_ctx_jobs_set(sat_ctx_t *s, int jobs);
+int sat_ctx_run(sat_ctx_t *s);
+int sat_main(int argc, char **argv);
 
 #endif
 
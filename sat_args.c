@@ -2,6 +2,8 @@
 
 unsigned long flags_general;
 unsigned long flags_input;
+unsigned long flags_batch;
+unsigned long flags_solve;
 
 #define _ARG_TABLE_IDX_DEFINE_
 #include "sat_args_defines.h"
@@ -18,6 +20,7 @@ void sat_args_init(void)
 	unsigned long flags_print_fields;
 	unsigned long flags_print_speeds;
 	unsigned long flags_print;
+	unsigned long flags_display;
 
 #define _ARG_TABLE_ENTRIES_INIT_
 #include "sat_args_defines.h"
@@ -25,6 +28,8 @@ void sat_args_init(void)
 
 	flags_general = FLG(HELP) | FLG(CURSOR);
 	flags_input = FLG(INPUT_STRING) | FLG(INPUT_FILE);
+	flags_batch = FLG(INPUT_BATCH) | FLG(BATCH_JOBS);
+	flags_solve = FLG(SOLVE_ONE) | FLG(SOLVE_NUM) | FLG(SOLVE_COUNT);
 
 	flags_print_fields = FLG(PRINT_NONE) | FLG(PRINT_CODE) |
 		FLG(PRINT_DIRECTION) | FLG(PRINT_FLAG) | FLG(PRINT_COLOUR) |
@@ -32,6 +37,7 @@ void sat_args_init(void)
 	flags_print_speeds = FLG(PRINT_NONE) | FLG(PRINT_SLOW) |
 		FLG(PRINT_MEDIUM) | FLG(PRINT_RAPID);
 	flags_print = flags_print_fields | flags_print_speeds;
+	flags_display = flags_print_fields & ~FLG(PRINT_NONE);
 
 #define _ARG_TABLE_INCOMPAT_INIT_
 #include "sat_args_defines.h"
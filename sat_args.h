@@ -6,7 +6,7 @@
 #define FLG(arg) sat_opts[IDX(arg)].flag
 #define ICP(arg) sat_opts[IDX(arg)].incompat
 #define OPT_INPUT_DEFAULT 1
-#define OPT_STRING "-heocdltnsmrp:f:"
+#define OPT_STRING "-heocdltnsmrp:f:B:j:1k:CgT:S"
 
 typedef struct sat_opt_t {
 	char opt;
@@ -20,6 +20,8 @@ typedef struct sat_opt_t {
 
 extern unsigned long flags_general;
 extern unsigned long flags_input;
+extern unsigned long flags_batch;
+extern unsigned long flags_solve;
 extern sat_opt_t sat_opts[];
 
 void sat_args_init(void);
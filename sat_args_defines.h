@@ -1,20 +1,41 @@
 #include "sat_args_macros.h"
 
 ARG_START
-	ARG_ENTRY(HELP,'h', flags_print | flags_input)
-	ARG_ENTRY(CURSOR, 'e', flags_print | flags_input)
+	ARG_ENTRY(HELP,'h', flags_print | flags_input | flags_batch |
+		flags_solve)
+	ARG_ENTRY(CURSOR, 'e', flags_print | flags_input | flags_batch |
+		flags_solve)
 	ARG_ENTRY(PRINT_NONE, 'n', flags_general | flags_print_speeds |
 		flags_print_fields)
-	ARG_ENTRY(PRINT_CODE, 'o', flags_general | flags_print_fields)
-	ARG_ENTRY(PRINT_DIRECTION, 'd', flags_general | flags_print_fields)
-	ARG_ENTRY(PRINT_FLAG, 'l', flags_general | flags_print_fields)
-	ARG_ENTRY(PRINT_COLOUR, 'c', flags_general | flags_print_fields)
-	ARG_ENTRY(PRINT_MONITOR, 't', flags_general | flags_print_fields)
+	ARG_ENTRY(PRINT_CODE, 'o', flags_general | flags_print_fields |
+		flags_batch)
+	ARG_ENTRY(PRINT_DIRECTION, 'd', flags_general | flags_print_fields |
+		flags_batch)
+	ARG_ENTRY(PRINT_FLAG, 'l', flags_general | flags_print_fields |
+		flags_batch)
+	ARG_ENTRY(PRINT_COLOUR, 'c', flags_general | flags_print_fields |
+		flags_batch)
+	ARG_ENTRY(PRINT_MONITOR, 't', flags_general | flags_print_fields |
+		flags_batch)
 	ARG_ENTRY(PRINT_SLOW, 's', flags_general | flags_print_speeds)
 	ARG_ENTRY(PRINT_MEDIUM, 'm', flags_general | flags_print_speeds)
 	ARG_ENTRY(PRINT_RAPID, 'r', flags_general | flags_print_speeds)
-	ARG_ENTRY(INPUT_STRING, 'p', flags_general | FLG(INPUT_FILE))
-	ARG_ENTRY(INPUT_FILE, 'f', flags_general | FLG(INPUT_STRING))
+	ARG_ENTRY(INPUT_STRING, 'p', flags_general | FLG(INPUT_FILE) |
+		flags_batch)
+	ARG_ENTRY(INPUT_FILE, 'f', flags_general | FLG(INPUT_STRING) |
+		flags_batch)
+	ARG_ENTRY(INPUT_BATCH, 'B', flags_general | flags_display |
+		FLG(INPUT_STRING) | FLG(INPUT_FILE) | FLG(SOLVE_COUNT) |
+		FLG(ENGINE_STATS))
+	ARG_ENTRY(BATCH_JOBS, 'j', flags_general | flags_display |
+		FLG(INPUT_STRING) | FLG(INPUT_FILE) | FLG(SOLVE_COUNT) |
+		FLG(ENGINE_STATS))
+	ARG_ENTRY(SOLVE_ONE, '1', flags_general | flags_solve)
+	ARG_ENTRY(SOLVE_NUM, 'k', flags_general | flags_solve)
+	ARG_ENTRY(SOLVE_COUNT, 'C', flags_general | flags_solve | flags_batch)
+	ARG_ENTRY(ENGINE_SYNC, 'g', flags_general)
+	ARG_ENTRY(ENGINE_THREADS, 'T', flags_general)
+	ARG_ENTRY(ENGINE_STATS, 'S', flags_general | flags_batch)
 	ARG_ENTRY(INPUT_MAX, 0, 0)
 ARG_END
 
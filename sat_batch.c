@@ -0,0 +1,278 @@
+#include "sat.h"
+#include "sat_batch.h"
+#include "char_stream.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_NAMES_MIN 64
+#define BATCH_LINE_SZ 4096
+#define NSEC_PER_SEC 1000000000.0
+#define NSEC_PER_MSEC 1000000.0
+
+/* a batch of CNF files solved by a pool of worker threads. each worker takes
+ * the next unsolved file, runs a solver context of its own on it and reports
+ * the results as soon as they are in */
+typedef struct batch_t {
+	char **names;
+	int num;
+	int sz;
+	int next;
+	int sat_num;
+	int unsat_num;
+	int fail_num;
+	int assignment_max;
+	int is_sync;
+	int sync_threads;
+	int comp_jobs;
+	unsigned long long solve_ns;
+	pthread_mutex_t lock;
+} batch_t;
+
+static unsigned long long batch_clock_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int batch_name_add(batch_t *b, char *name)
+{
+	if (b->num == b->sz) {
+		int sz = b->sz ? 2 * b->sz : BATCH_NAMES_MIN;
+		char **names;
+
+		if (!(names = realloc(b->names, sz * sizeof(char *))))
+			return -1;
+		b->names = names;
+		b->sz = sz;
+	}
+
+	if (!(b->names[b->num] = strdup(name)))
+		return -1;
+
+	b->num++;
+	return 0;
+}
+
+static void batch_names_clr(batch_t *b)
+{
+	int i;
+
+	for (i = 0; i < b->num; i++)
+		free(b->names[i]);
+	free(b->names);
+	b->names = NULL;
+	b->num = 0;
+	b->sz = 0;
+}
+
+/* all regular files in dir, in alphabetical order */
+static int batch_dir_read(batch_t *b, char *dir)
+{
+	struct dirent **ents;
+	int i, n, ret = 0;
+
+	if ((n = scandir(dir, &ents, NULL, alphasort)) < 0) {
+		fprintf(stderr, "could not read directory: %s\n", dir);
+		return -1;
+	}
+
+	for (i = 0; i < n; i++) {
+		char path[BATCH_LINE_SZ];
+		struct stat st;
+
+		snprintf(path, sizeof(path), "%s/%s", dir, ents[i]->d_name);
+		if (!ret && !stat(path, &st) && S_ISREG(st.st_mode))
+			ret = batch_name_add(b, path);
+		free(ents[i]);
+	}
+	free(ents);
+
+	return ret;
+}
+
+/* one file name per line, empty lines are skipped */
+static int batch_list_read(batch_t *b, char *list)
+{
+	char line[BATCH_LINE_SZ];
+	FILE *f;
+	int ret = 0;
+
+	if (!(f = fopen(list, "r"))) {
+		fprintf(stderr, "could not open file: %s\n", list);
+		return -1;
+	}
+
+	while (!ret && fgets(line, sizeof(line), f)) {
+		line[strcspn(line, "\r\n")] = 0;
+		if (*line)
+			ret = batch_name_add(b, line);
+	}
+	fclose(f);
+
+	return ret;
+}
+
+static void batch_report(batch_t *b, char *name, int ret,
+	unsigned long long ns, char *results, size_t len)
+{
+	pthread_mutex_lock(&b->lock);
+	if (ret < 0)
+		b->fail_num++;
+	else if (ret)
+		b->sat_num++;
+	else
+		b->unsat_num++;
+	b->solve_ns += ns;
+	pthread_mutex_unlock(&b->lock);
+
+	/* keep each instance's output in one piece */
+	flockfile(stdout);
+	fprintf(stdout, "==> %s: %s (%.3f ms)\n", name, ret < 0 ? "error" :
+		ret ? "satisfyable" : "not satisfyable", ns / NSEC_PER_MSEC);
+	if (len)
+		fwrite(results, 1, len, stdout);
+	fflush(stdout);
+	funlockfile(stdout);
+}
+
+static void batch_solve(batch_t *b, char *name)
+{
+	unsigned long long start = batch_clock_ns();
+	char *results = NULL;
+	size_t len = 0;
+	sat_ctx_t *s = NULL;
+	FILE *out = NULL;
+	cs_t *cs;
+	int ret = -1;
+
+	if (!(cs = cs_open(cs_file_type(name), name)))
+		goto Exit;
+
+	if (!(s = sat_ctx_new(cs))) {
+		cs_close(cs);
+		goto Exit;
+	}
+
+	if (!(out = open_memstream(&results, &len)))
+		goto Exit;
+
+	sat_ctx_output_set(s, out);
+	sat_ctx_assignment_max_set(s, b->assignment_max);
+	sat_ctx_sync_set(s, b->is_sync);
+	sat_ctx_sync_threads_set(s, b->sync_threads);
+	sat_ctx_jobs_set(s, b->comp_jobs);
+	ret = sat_ctx_run(s);
+
+Exit:
+	if (s)
+		sat_ctx_free(s);
+	if (out)
+		fclose(out);
+	batch_report(b, name, ret, batch_clock_ns() - start, results, len);
+	free(results);
+}
+
+static void *batch_worker(void *o)
+{
+	batch_t *b = (batch_t *)o;
+
+	while (1) {
+		int idx;
+
+		pthread_mutex_lock(&b->lock);
+		idx = b->next++;
+		pthread_mutex_unlock(&b->lock);
+
+		if (idx >= b->num)
+			break;
+		batch_solve(b, b->names[idx]);
+	}
+
+	return NULL;
+}
+
+/* solves every file in the directory path, or every file listed in the file
+ * path, on jobs worker threads. jobs <= 0 stands for one thread per online
+ * processor. assignment_max > 0 stops each instance after that many
+ * assignments. is_sync steps the instances' CAs synchronously, on
+ * sync_threads threads each. the instances' components are solved on the
+ * processors left over by the workers, one thread at least */
+int sat_batch(char *path, int jobs, int assignment_max, int is_sync,
+	int sync_threads)
+{
+	batch_t b;
+	pthread_t *workers;
+	unsigned long long start, wall_ns;
+	struct stat st;
+	int i, cpu_num, ret = -1;
+
+	memset(&b, 0, sizeof(batch_t));
+	b.assignment_max = assignment_max;
+	b.is_sync = is_sync;
+	b.sync_threads = sync_threads;
+	if (stat(path, &st)) {
+		fprintf(stderr, "could not open: %s\n", path);
+		return -1;
+	}
+
+	if ((S_ISDIR(st.st_mode) ? batch_dir_read(&b, path) :
+		batch_list_read(&b, path))) {
+		goto Exit;
+	}
+
+	if (!b.num) {
+		fprintf(stderr, "no input files in: %s\n", path);
+		goto Exit;
+	}
+
+	if ((cpu_num = sysconf(_SC_NPROCESSORS_ONLN)) <= 0)
+		cpu_num = 1;
+	if (jobs <= 0)
+		jobs = cpu_num;
+	if (jobs > b.num)
+		jobs = b.num;
+
+	/* the instances' components share what processors the workers leave */
+	if ((b.comp_jobs = cpu_num / jobs) < 1)
+		b.comp_jobs = 1;
+
+	if (!(workers = calloc(jobs, sizeof(pthread_t))))
+		goto Exit;
+
+	pthread_mutex_init(&b.lock, NULL);
+	start = batch_clock_ns();
+	for (i = 0; i < jobs && !pthread_create(&workers[i], NULL,
+		batch_worker, &b); i++);
+
+	/* should no worker start, the calling thread solves the batch itself */
+	if (!i)
+		batch_worker(&b);
+	jobs = i ? i : 1;
+	while (i--)
+		pthread_join(workers[i], NULL);
+	wall_ns = batch_clock_ns() - start;
+	pthread_mutex_destroy(&b.lock);
+	free(workers);
+
+	fprintf(stdout, "\n%d instances: %d satisfyable, %d not satisfyable, "
+		"%d failed\n", b.num, b.sat_num, b.unsat_num, b.fail_num);
+	fprintf(stdout, "threads: %d, wall time: %.3f s, solve time: %.3f s, "
+		"throughput: %.1f instances/s\n", jobs, wall_ns / NSEC_PER_SEC,
+		b.solve_ns / NSEC_PER_SEC,
+		b.num / (wall_ns ? wall_ns / NSEC_PER_SEC : 1));
+	fflush(stdout);
+	ret = b.fail_num ? -1 : 0;
+
+Exit:
+	batch_names_clr(&b);
+	return ret;
+}
+
@@ -0,0 +1,8 @@
+#ifndef _SAT_BATCH_H_
+#define _SAT_BATCH_H_
+
+int sat_batch(char *path, int jobs, int assignment_max, int is_sync,
+	int sync_threads);
+
+#endif
+
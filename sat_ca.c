@@ -2,6 +2,22 @@
 #include "sat_ca.h"
 #include "util.h"
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+
+#define SCAN_MAP_WORD_BITS (8 * (int)sizeof(unsigned long))
+/* the cells are laid out in blocks of BLOCK_DIM x BLOCK_DIM */
+#define BLOCK_SHIFT 6
+#define BLOCK_DIM (1 << BLOCK_SHIFT)
+#define BLOCK_MASK (BLOCK_DIM - 1)
+#define BLOCK_CELLS_SHIFT (2 * BLOCK_SHIFT)
+#define BLOCK_CELLS (1 << BLOCK_CELLS_SHIFT)
+/* how often the blocks gone quiescent are let go of */
+#define BLOCK_SWEEP_GENERATIONS 64
+#define BLOCK_SWEEP_SCANS (1 << 16)
+/* fewer active cells per tile are not worth a thread's while */
+#define TILE_CELLS_MIN 512
 
 #define ID_UNDEFINED 0
 #define CL_UNDEFINED 0
@@ -89,31 +105,101 @@ typedef struct monitor_t {
 	int is_active;
 } monitor_t;
 
-typedef struct ca_t {
-	struct ca_t *neighbours[8];
-	ca_code_t code;
-	ca_direction_t dir;
-	ca_colour_t col;
-	ca_flag_t flag;
-	int id;
-	monitor_t mon;
-	void *loop;
-} ca_t;
-
-typedef struct ca_space_t {
-	ca_space_cb_t *cb;
-	ca_t **sp;
-	int sp_dim;
-	int loop_dim;
-	sat_print_field_t print_field;
-	int x0;
-	int y0;
-} ca_space_t;
+/* a cell is a handle held by its block. the handle points back at the block
+ * and its offset from the block's first handle is the cell's offset in it */
+typedef struct ca_block_t *ca_t;
+
+/* the handles and fields of BLOCK_CELLS consecutive cells. a block is
+ * allocated the first time one of its cells is looked up, and let go of once
+ * its cells are quiescent and no event refers to them. the cells of its rows
+ * and columns from row_max and col_max on lie on the space's border.
+ * states[] and ids[] are indexed by the space's read or write buffer, the two
+ * are one and the same unless the space is stepped synchronously */
+typedef struct ca_block_t {
+	ca_t cells[BLOCK_CELLS];
+	ca_space_t *space;
+	int idx;
+	int row_max;
+	int col_max;
+	struct sat_loop_t *loops[BLOCK_CELLS];
+	monitor_t *mons[BLOCK_CELLS];
+	unsigned int *states[2];
+	unsigned short *ids[2];
+	unsigned char *is_dirty;
+} ca_block_t;
+
+/* a cell's code, direction, colour and one-hot flag are packed into a single
+ * state word, so rules testing several of them on a neighbour read it once */
+#define ST_CODE_SHIFT 0
+#define ST_DIR_SHIFT 4
+#define ST_COL_SHIFT 8
+#define ST_FLAG_SHIFT 12
+#define ST_CODE_MASK (0xf << ST_CODE_SHIFT)
+#define ST_DIR_MASK (0x7 << ST_DIR_SHIFT)
+#define ST_COL_MASK (0x7 << ST_COL_SHIFT)
+#define ST_FLAG_MASK (0x1ff << ST_FLAG_SHIFT)
+#define ST(field, val) ((unsigned int)(val) << ST_##field##_SHIFT)
+#define ST_GET(st, field) (((st) & ST_##field##_MASK) >> ST_##field##_SHIFT)
+#define ST_QUIESCENT (ST(CODE, CD_QUIESCENT) | ST(DIR, DR_QUIESCENT) | \
+	ST(COL, CL_QUIESCENT) | ST(FLAG, FL_QUIESCENT))
+
+#define CA_SPACE(ca) ((*(ca))->space)
+#define CA_STATE(ca) (*ca_state(ca))
+#define CA_CODE(ca) ST_GET(CA_STATE(ca), CODE)
+#define CA_DIR(ca) ST_GET(CA_STATE(ca), DIR)
+#define CA_COL(ca) ST_GET(CA_STATE(ca), COL)
+#define CA_FLAG(ca) ST_GET(CA_STATE(ca), FLAG)
+#define CA_DIR_W(ca) ST_GET(*ca_state_w(ca), DIR)
+#define CA_SET(ca, field, val) \
+	ca_state_set(ca, ST_##field##_MASK, ST(field, val))
+#define CA_ID(ca) (*ca_id(ca))
+#define CA_LOOP(ca) (*ca_loop(ca))
+#define CA_MON(ca) (*ca_mon(ca))
+
+typedef enum {
+	TILE_OP_SCAN = 0,
+	TILE_OP_DIRTY = 1,
+	TILE_OP_EVENT = 2,
+	TILE_OP_CALL = 3
+} tile_op_type_t;
+
+/* something a tile's scans may not do themselves, as it touches more than
+ * the cell being scanned. it is carried out once all tiles are done */
+typedef struct tile_op_t {
+	tile_op_type_t type;
+	event_func_t func;
+	void *data;
+} tile_op_t;
+
+/* a run of the scan bitmap's words, scanned by a thread of its own */
+typedef struct ca_tile_t {
+	ca_space_t *space;
+	int word_start;
+	int word_end;
+	tile_op_t *ops;
+	int ops_num;
+	int ops_sz;
+	int is_error;
+} ca_tile_t;
+
+typedef struct ca_tiles_t {
+	ca_tile_t *tile;
+	int num;
+	int cells_min;
+	pthread_t *threads;
+	int thread_num;
+	pthread_mutex_t lock;
+	pthread_barrier_t barrier;
+	int is_init;
+	int is_done;
+} ca_tiles_t;
 
 typedef struct sat_loop_t {
 	struct sat_loop_t *next;
+	ca_space_t *space;
 	ca_t **ca_list;
 	int is_success;
+	int is_recorded;
 } sat_loop_t;
 
 PRINT_SCHEME_START(sat_print_code)
@@ -157,18 +243,14 @@ PRINT_SCHEME_START(sat_print_colour)
 	PRINT_SCHEME_ENTRY(CL_BLUE, 'b', COL_CYAN, ATTR_DULL)
 	PRINT_SCHEME_END;
 
-	void sat_print_init(void *o, int dim, sat_print_speed_t print_speed);
-	void sat_print_uninit(void);
+	void sat_print_init(ca_space_t *s, sat_print_speed_t print_speed);
+	void sat_print_uninit(ca_space_t *s);
 
-	static sat_loop_t *loop_queue_active;
-	static sat_loop_t *loop_queue_success;
-	static ca_space_t ca_space;
-	static table_t *table;
-	static int loop_len, clause_num;
 	static void loop_fail_reset(void *o);
 	static void mon_spread_scan(void *o);
 	static void ca_scan(void *o);
 	static void mon_spread_init_phase2(void *o);
+	static void error_set(void);
 	static code2code_t truth_values[] = {
 		{CD_ZERO, SAT_TV_FALSE},
 		{CD_ONE, SAT_TV_TRUE},
@@ -185,6 +267,353 @@ static code2code_t flag2idx[] = {
 	{FL_MONITOR_ALLERT, IDX_MONITOR_ALLERT},
 	{-1}
 };
+#define BLOCK_IDX(idx) ((idx) >> BLOCK_CELLS_SHIFT)
+#define BLOCK_OFF(idx) ((idx) & (BLOCK_CELLS - 1))
+
+static int ca_off(ca_t *ca)
+{
+	return ca - (*ca)->cells;
+}
+
+static int ca_idx(ca_t *ca)
+{
+	return (*ca)->idx << BLOCK_CELLS_SHIFT | ca_off(ca);
+}
+
+static ca_block_t *block_new(ca_space_t *s, int idx)
+{
+	int i, bufs = s->cb->is_sync ? 2 : 1;
+	ca_block_t *blk;
+
+	if (!(blk = calloc(1, sizeof(ca_block_t) + bufs * BLOCK_CELLS *
+		(sizeof(unsigned int) + sizeof(unsigned short)) +
+		(s->cb->is_sync ? BLOCK_CELLS : 0)))) {
+		return NULL;
+	}
+
+	blk->states[0] = (unsigned int *)(blk + 1);
+	blk->states[1] = blk->states[0] + (bufs - 1) * BLOCK_CELLS;
+	blk->ids[0] = (unsigned short *)(blk->states[0] + bufs * BLOCK_CELLS);
+	blk->ids[1] = blk->ids[0] + (bufs - 1) * BLOCK_CELLS;
+	if (s->cb->is_sync) {
+		blk->is_dirty =
+			(unsigned char *)(blk->ids[0] + bufs * BLOCK_CELLS);
+	}
+
+	for (i = 0; i < bufs * BLOCK_CELLS; i++) {
+		blk->states[0][i] = ST_QUIESCENT;
+		blk->ids[0][i] = ID_UNDEFINED;
+	}
+
+	for (i = 0; i < BLOCK_CELLS; i++)
+		blk->cells[i] = blk;
+	blk->space = s;
+	blk->idx = idx;
+	blk->row_max = MIN(BLOCK_MASK,
+		s->sp_dim - 1 - (idx / s->block_dim) * BLOCK_DIM);
+	blk->col_max = MIN(BLOCK_MASK,
+		s->sp_dim - 1 - (idx % s->block_dim) * BLOCK_DIM);
+
+	return blk;
+}
+
+/* the tile being scanned by the calling thread, if any */
+static __thread ca_tile_t *tile_cur;
+
+/* the block at idx, allocated unless it already has been. the tiles' threads
+ * allocate under the tiles' lock and read the blocks' table atomically. should
+ * the block not be allocated, the run fails and the spare block stands in */
+static ca_block_t *block_get(ca_space_t *s, int idx)
+{
+	ca_block_t *blk;
+
+	if ((blk = __atomic_load_n(&s->blocks[idx], __ATOMIC_ACQUIRE)))
+		return blk;
+
+	if (tile_cur)
+		pthread_mutex_lock(&s->tiles->lock);
+	if (!(blk = s->blocks[idx]) && (blk = block_new(s, idx))) {
+		__atomic_store_n(&s->blocks[idx], blk, __ATOMIC_RELEASE);
+		if (s->block_max < ++s->block_num)
+			s->block_max = s->block_num;
+	}
+	if (tile_cur)
+		pthread_mutex_unlock(&s->tiles->lock);
+
+	if (blk)
+		return blk;
+
+	error_set();
+	return s->block_spare;
+}
+
+/* the cell at idx, looked up through the blocks' table */
+static ca_t *sp_cell_idx(ca_space_t *s, int idx)
+{
+	return &block_get(s, BLOCK_IDX(idx))->cells[BLOCK_OFF(idx)];
+}
+
+/* a block's cells are quiescent and no event is due for any of them */
+static int block_is_quiet(ca_space_t *s, ca_block_t *blk)
+{
+	int i;
+
+	for (i = 0; i < BLOCK_CELLS; i++) {
+		if (blk->states[s->rd][i] != ST_QUIESCENT ||
+			blk->ids[s->rd][i] != ID_UNDEFINED || blk->loops[i] ||
+			blk->mons[i]) {
+			return 0;
+		}
+	}
+
+	for (i = 0; i < BLOCK_CELLS; i++) {
+		if (event_is_pending(&blk->cells[i]))
+			return 0;
+	}
+
+	return 1;
+}
+
+/* lets go of the blocks whose cells have all gone quiescent. a synchronous
+ * space keeps those with cells due for a scan */
+static void blocks_sweep(ca_space_t *s)
+{
+	int i, j;
+
+	for (i = 0; i < s->block_dir_sz; i++) {
+		ca_block_t *blk = s->blocks[i];
+
+		if (!blk || !block_is_quiet(s, blk))
+			continue;
+
+		if (s->cb->is_sync) {
+			unsigned long *word = &s->scan_map[i * BLOCK_CELLS /
+				SCAN_MAP_WORD_BITS];
+
+			for (j = 0; j < BLOCK_CELLS / SCAN_MAP_WORD_BITS &&
+				!word[j]; j++);
+			if (j < BLOCK_CELLS / SCAN_MAP_WORD_BITS)
+				continue;
+		}
+
+		free(blk);
+		s->blocks[i] = NULL;
+		s->block_num--;
+	}
+}
+
+static void blocks_sweep_event(void *o)
+{
+	blocks_sweep((ca_space_t *)o);
+}
+
+static unsigned int *ca_state(ca_t *ca)
+{
+	return &(*ca)->states[CA_SPACE(ca)->rd][ca_off(ca)];
+}
+
+/* the cell's state in the buffer being written. unless the space is stepped
+ * synchronously, it is the very one being read */
+static unsigned int *ca_state_w(ca_t *ca)
+{
+	return &(*ca)->states[CA_SPACE(ca)->wr][ca_off(ca)];
+}
+
+static void tile_op_add(tile_op_type_t type, event_func_t func, void *data)
+{
+	tile_op_t *op;
+
+	if (tile_cur->ops_num == tile_cur->ops_sz) {
+		int sz = tile_cur->ops_sz ? 2 * tile_cur->ops_sz : 64;
+
+		if (!(op = realloc(tile_cur->ops, sz * sizeof(tile_op_t)))) {
+			tile_cur->is_error = 1;
+			return;
+		}
+		tile_cur->ops = op;
+		tile_cur->ops_sz = sz;
+	}
+
+	op = &tile_cur->ops[tile_cur->ops_num++];
+	op->type = type;
+	op->func = func;
+	op->data = data;
+}
+
+/* a cell written in a synchronous generation is copied back to the other
+ * buffer once the buffers are swapped */
+static void ca_dirty_set(ca_t *ca)
+{
+	ca_space_t *s = CA_SPACE(ca);
+	unsigned char *is_dirty;
+
+	if (!s->cb->is_sync)
+		return;
+
+	/* the cells written to the spare block are not kept */
+	is_dirty = &(*ca)->is_dirty[ca_off(ca)];
+	if (*is_dirty || *ca == s->block_spare)
+		return;
+
+	if (tile_cur) {
+		tile_op_add(TILE_OP_DIRTY, NULL, ca);
+		return;
+	}
+
+	if (s->dirty_num == s->dirty_sz) {
+		int sz = s->dirty_sz ? 2 * s->dirty_sz : BLOCK_CELLS;
+		int *dirty;
+
+		if (!(dirty = realloc(s->dirty, sz * sizeof(int)))) {
+			error_set();
+			return;
+		}
+		s->dirty = dirty;
+		s->dirty_sz = sz;
+	}
+
+	*is_dirty = 1;
+	s->dirty[s->dirty_num++] = ca_idx(ca);
+}
+
+static void ca_state_set(ca_t *ca, unsigned int mask, unsigned int st)
+{
+	unsigned int *state = ca_state_w(ca);
+
+	*state = (*state & ~mask) | st;
+	ca_dirty_set(ca);
+}
+
+static unsigned short *ca_id(ca_t *ca)
+{
+	return &(*ca)->ids[CA_SPACE(ca)->rd][ca_off(ca)];
+}
+
+static void ca_id_set(ca_t *ca, int id)
+{
+	(*ca)->ids[CA_SPACE(ca)->wr][ca_off(ca)] = id;
+	ca_dirty_set(ca);
+}
+
+/* events due to a scan are added once its tile is done */
+static void ca_event_add(event_func_t func, void *data)
+{
+	if (tile_cur)
+		tile_op_add(TILE_OP_EVENT, func, data);
+	else
+		event_add(func, data);
+}
+
+/* as are the calls reading or writing more than the cell scanned */
+static void ca_call(event_func_t func, void *data)
+{
+	if (tile_cur)
+		tile_op_add(TILE_OP_CALL, func, data);
+	else
+		func(data);
+}
+
+/* the cell is to be scanned in the next generation. the synchronous engine
+ * marks it in the bitmap of the cells due, the event driven engine's scans
+ * remain events of their own, ordered as the fields' events they follow */
+static void ca_scan_set(ca_t *ca)
+{
+	ca_space_t *s = CA_SPACE(ca);
+	unsigned long *word, bit;
+	int idx;
+
+	if (!s->cb->is_sync) {
+		event_add_once(ca_scan, ca);
+		return;
+	}
+
+	if (tile_cur) {
+		tile_op_add(TILE_OP_SCAN, NULL, ca);
+		return;
+	}
+
+	idx = ca_idx(ca);
+	word = &s->scan_map_next[idx / SCAN_MAP_WORD_BITS];
+	bit = 1UL << idx % SCAN_MAP_WORD_BITS;
+	if (*word & bit)
+		return;
+
+	*word |= bit;
+	s->scan_next_num++;
+}
+
+/* a field is written by an event of its own in the next generation, unless
+ * the space is stepped synchronously in which case it is written straight to
+ * the write buffer */
+static void ca_write(ca_t *ca, event_func_t func)
+{
+	if (CA_SPACE(ca)->cb->is_sync)
+		func(ca);
+	else
+		event_add(func, ca);
+}
+
+static sat_loop_t **ca_loop(ca_t *ca)
+{
+	return &(*ca)->loops[ca_off(ca)];
+}
+
+static void ca_loop_set(ca_t *ca, sat_loop_t *loop)
+{
+	*ca_loop(ca) = loop;
+}
+
+static monitor_t **ca_mon(ca_t *ca)
+{
+	return &(*ca)->mons[ca_off(ca)];
+}
+
+static void ca_mon_set(ca_t *ca, monitor_t *mon)
+{
+	*ca_mon(ca) = mon;
+}
+
+static int mon_is_active(ca_t *ca)
+{
+	return CA_MON(ca) && CA_MON(ca)->is_active;
+}
+
+/* a cell's index is that of its block followed by its row and column in the
+ * block */
+static int sp_idx(ca_space_t *s, int n, int m)
+{
+	return ((n >> BLOCK_SHIFT) * s->block_dim + (m >> BLOCK_SHIFT)) *
+		BLOCK_CELLS + ((n & BLOCK_MASK) << BLOCK_SHIFT) +
+		(m & BLOCK_MASK);
+}
+
+static void sp_coordinates(ca_space_t *s, int idx, coordinate_euclid_t *cell)
+{
+	int blk = BLOCK_IDX(idx), off = BLOCK_OFF(idx);
+
+	cell->n = (blk / s->block_dim) * BLOCK_DIM + (off >> BLOCK_SHIFT);
+	cell->m = (blk % s->block_dim) * BLOCK_DIM + (off & BLOCK_MASK);
+}
+
+/* a neighbour lies at a fixed offset from the cell's handle, unless the cell
+ * is on its block's border, or on the space's border in which case the
+ * neighbour wraps around to its far side */
+static ca_t *ca_neighbour(ca_t *ca, wind_dir_t dir)
+{
+	ca_block_t *blk = *ca;
+	ca_space_t *s = blk->space;
+	int off = ca_off(ca), row = off >> BLOCK_SHIFT, col = off & BLOCK_MASK;
+	coordinate_euclid_t cell, neighbour;
+
+	if (row && col && row < blk->row_max && col < blk->col_max)
+		return ca + s->nei_offsets[dir];
+
+	sp_coordinates(s, ca_idx(ca), &cell);
+	coordinate_moore_neighbour(s->sp_dim, s->sp_dim, &cell, dir,
+		&neighbour);
+	return sp_cell_idx(s, sp_idx(s, neighbour.n, neighbour.m));
+}
+
 static wind_dir_t cadir2dir(ca_direction_t dir)
 {
 	code2code_t cd2d[] = {
@@ -237,9 +666,14 @@ static ca_direction_t dir_opposite(ca_direction_t dir)
 	return opp;
 }
 
+/* the tiles' threads have no event loop of their own, an error they run into
+ * is raised once their tile is merged */
 static void error_set(void)
 {
-	signal_set(SIG_ERROR);
+	if (tile_cur)
+		tile_cur->is_error = 1;
+	else
+		signal_set(SIG_ERROR);
 }
 
 static void signal_loop(void *o)
@@ -250,16 +684,17 @@ static void signal_loop(void *o)
 static ca_t *pointing_neighbour(void *o)
 {
 	ca_t *ca = (ca_t *)o;
-	ca_direction_t opp = dir_opposite(ca->dir);
+	ca_direction_t opp = dir_opposite(CA_DIR(ca));
 
-	return opp == DR_UNDEFINED ? NULL : ca->neighbours[cadir2dir(opp)];
+	return opp == DR_UNDEFINED ? NULL : ca_neighbour(ca, cadir2dir(opp));
 }
 
 static sat_loop_t *loop_remove_active(sat_loop_t *loop)
 {
 	sat_loop_t **q, *ret;
 
-	for (q = &loop_queue_active; (ret = *q) && *q != loop; q = &(*q)->next);
+	for (q = &loop->space->loop_queue_active; (ret = *q) && *q != loop;
+		q = &(*q)->next);
 
 	*q = (*q)->next;
 	event_add_once(signal_loop, NULL);
@@ -271,8 +706,8 @@ static void loop_del(sat_loop_t *loop)
 {
 	int i;
 
-	for (i = 0; i < loop_len; i++)
-		((ca_t *)loop->ca_list[i])->loop = NULL;
+	for (i = 0; i < loop->space->loop_len; i++)
+		ca_loop_set(loop->ca_list[i], NULL);
 	free(loop->ca_list);
 	free(loop);
 }
@@ -280,25 +715,27 @@ static void loop_del(sat_loop_t *loop)
 static void loop_new(void *o)
 {
 	ca_t *tmp = (ca_t *)o, **ca_list;
+	ca_space_t *s = CA_SPACE(tmp);
 	sat_loop_t *loop;
 	int i;
 
 	if (!(loop = calloc(1, sizeof(sat_loop_t))))
 		goto Error;
 
-	if (!(ca_list = calloc(loop_len, sizeof(ca_t *)))) {
+	if (!(ca_list = calloc(s->loop_len, sizeof(ca_t *)))) {
 		free(loop);
 		goto Error;
 	}
 
+	loop->space = s;
 	loop->ca_list = ca_list;
-	for (i = 0; i < loop_len; i++) {
-		tmp->loop = loop;
+	for (i = 0; i < s->loop_len; i++) {
+		ca_loop_set(tmp, loop);
 		loop->ca_list[i] = tmp;
 		tmp = pointing_neighbour(tmp);
 	}
-	loop->next = loop_queue_active;
-	loop_queue_active = loop;
+	loop->next = s->loop_queue_active;
+	s->loop_queue_active = loop;
 	return;
 
 Error:
@@ -307,7 +744,7 @@ Error:
 
 static void loop_new_set(ca_t *ca)
 {
-	event_add(loop_new, ca);
+	ca_event_add(loop_new, ca);
 }
 
 static void loop_fail(void *o)
@@ -320,9 +757,10 @@ static void loop_fail_set(void *o)
 	sat_loop_t *loop = (sat_loop_t *)o;
 	int i;
 
-	for (i = 0; i < loop_len && loop->ca_list[i]->flag != FL_ERASE_LOOP;
-		i++);
-	event_add_once(i < loop_len ? loop_fail_reset : loop_fail, o);
+	for (i = 0; i < loop->space->loop_len &&
+		CA_FLAG(loop->ca_list[i]) != FL_ERASE_LOOP; i++);
+	event_add_once(i < loop->space->loop_len ? loop_fail_reset : loop_fail,
+		o);
 }
 
 static void loop_fail_reset(void *o)
@@ -330,25 +768,91 @@ static void loop_fail_reset(void *o)
 	event_add_once(loop_fail_set, o);
 }
 
+static ca_t *loop_assignment_get_next(sat_loop_t *loop)
+{
+	ca_t **ca;
+
+	for (ca = loop->ca_list; CA_CODE(*ca) != CD_TURN_LEFT; ca++);
+	return pointing_neighbour(*ca);
+}
+
+/* a successful loop's assignment is recorded, and handed on to whoever is
+ * listening, as soon as the loop succeeds rather than once the run is over */
+static int loop_assignment_record(sat_loop_t *loop)
+{
+	ca_space_t *s = loop->space;
+	table_t *table = s->table;
+	ca_t *ca;
+	int id, idx;
+
+	if (loop->is_recorded)
+		return 0;
+	loop->is_recorded = 1;
+
+	if ((idx = table_assignment_add(table)) < 0)
+		return -1;
+
+	ca = loop_assignment_get_next(loop);
+
+	for (id = 1; id <= table->var_num; id++) {
+		table_assignment_insert(table, idx, id,
+			code2code(truth_values, CA_CODE(ca)));
+		ca = pointing_neighbour(ca);
+	}
+
+	if (s->cb->assignment_cb)
+		s->cb->assignment_cb(s->cb->assignment_data, table, idx);
+	return 0;
+}
+
+/* loop_success() runs alongside the generation's code updates, the loop is
+ * read only once they have all been applied */
+static void loop_record(void *o)
+{
+	if (loop_assignment_record((sat_loop_t *)o))
+		error_set();
+}
+
+/* as many assignments as were asked for have been found */
+static int is_assignment_max(ca_space_t *s)
+{
+	return s->cb->assignment_max &&
+		s->success_num >= s->cb->assignment_max;
+}
+
 static void loop_success(void *o)
 {
 	sat_loop_t *loop = (sat_loop_t *)o;
+	ca_space_t *s = loop->space;
+
+	/* the run is being cut short, the loop is left to be torn down */
+	if (is_assignment_max(s))
+		return;
 
 	loop->is_success = 1;
 	loop_remove_active(loop);
-	loop->next = loop_queue_success;
-	loop_queue_success = loop;
+	loop->next = s->loop_queue_success;
+	s->loop_queue_success = loop;
+
+	/* when only counting, the loop is not even read */
+	if (!s->cb->is_count)
+		event_add(loop_record, loop);
+
+	s->success_num++;
+	if (is_assignment_max(s))
+		signal_set(SIG_LOOP);
 }
 
-static void loop_success_set(sat_loop_t *loop)
+static void loop_success_set(void *o)
 {
+	sat_loop_t *loop = (sat_loop_t *)o;
 	int i;
 
 	if (loop->is_success)
 		return;
-	for (i = 0; i < loop_len; i++) {
-		if (loop->ca_list[i]->mon.is_active ||
-			loop->ca_list[i]->flag == FL_ERASE_LOOP) {
+	for (i = 0; i < loop->space->loop_len; i++) {
+		if (mon_is_active(loop->ca_list[i]) ||
+			CA_FLAG(loop->ca_list[i]) == FL_ERASE_LOOP) {
 			return;
 		}
 	}
@@ -356,114 +860,260 @@ static void loop_success_set(sat_loop_t *loop)
 	event_add_once(loop_success, loop);
 }
 
-static int mon_init(monitor_t *mon, int offset, int pos_tbl_sz)
+static int mon_init(ca_t *ca, int offset, int pos_tbl_sz)
 {
-	if (!(mon->pos_tbl = calloc(pos_tbl_sz, sizeof(int))))
+	monitor_t *mon;
+
+	if (!(mon = calloc(1, sizeof(monitor_t) + pos_tbl_sz * sizeof(int))))
 		return -1;
+	mon->pos_tbl = (int *)(mon + 1);
 	mon->pos_tbl_sz = pos_tbl_sz;
 	mon->offset = offset;
 	mon->is_active = 1;
+
+	free(CA_MON(ca));
+	ca_mon_set(ca, mon);
 	return 0;
 }
 
 static void mon_uninit(void *o)
 {
-	monitor_t *mon = (monitor_t *)o;
+	ca_t *ca = (ca_t *)o;
 
-	if (mon->pos_tbl)
-		free(mon->pos_tbl);
-	mon->pos_tbl = NULL;
-	mon->pos_tbl_sz = 0;
-	mon->offset = 0;
-	mon->is_active = 0;
+	free(CA_MON(ca));
+	ca_mon_set(ca, NULL);
 }
 
 static void mon_uninit_set(ca_t *ca)
 {
-	event_add(mon_uninit, &ca->mon);
+	ca_event_add(mon_uninit, ca);
 }
 
 static void mon_deactivate(void *o)
 {
-	((monitor_t *)o)->is_active = 0;
+	ca_t *ca = (ca_t *)o;
+
+	if (CA_MON(ca))
+		CA_MON(ca)->is_active = 0;
 }
 
-static void mon_deactivate_set(monitor_t *mon)
+static void mon_deactivate_set(ca_t *ca)
 {
-	event_add(mon_deactivate, mon);
+	ca_event_add(mon_deactivate, ca);
 }
 
-static ca_t *ca_alloc(int num)
+/* the cells due in the scan bitmap's words start to end */
+static void ca_scan_words(ca_space_t *s, int start, int end)
 {
-	ca_t *ca;
 	int i;
 
-	if (!(ca = calloc(num, sizeof(ca_t))))
-		return NULL;
+	for (i = start; i < end; i++) {
+		unsigned long bits = s->scan_map[i];
+		int idx;
 
-	for (i = 0; i < num; i++) {
-		ca[i].code = CD_QUIESCENT;
-		ca[i].dir = DR_QUIESCENT;
-		ca[i].col = CL_QUIESCENT;
-		ca[i].flag = FL_QUIESCENT;
-		ca[i].id = ID_UNDEFINED;
-		ca[i].loop = NULL;
+		for (idx = i * SCAN_MAP_WORD_BITS; bits; idx++, bits >>= 1) {
+			if (bits & 1)
+				ca_scan(sp_cell_idx(s, idx));
+		}
 	}
+}
 
-	return ca;
+static void tile_scan(ca_tile_t *tile)
+{
+	tile_cur = tile;
+	ca_scan_words(tile->space, tile->word_start, tile->word_end);
+	tile_cur = NULL;
 }
 
-static void ca_space_free(ca_t **sp, int hight, int legnth)
+/* a worker scans its tile once every parallel generation. the space's
+ * fields are only read until all the tiles are done */
+static void *tile_thread(void *o)
 {
-	int i, j;
+	ca_tile_t *tile = (ca_tile_t *)o;
+	ca_tiles_t *tiles = tile->space->tiles;
 
-	if (!sp)
-		return;
-	for (i = 0; i < hight; i++) {
-		for (j = 0; j < legnth; j++)
-			mon_uninit(&sp[i][j].mon);
-		free(sp[i]);
+	/* wait for the barrier to be set up */
+	pthread_mutex_lock(&tiles->lock);
+	pthread_mutex_unlock(&tiles->lock);
+
+	while (1) {
+		pthread_barrier_wait(&tiles->barrier);
+		if (tiles->is_done)
+			break;
+		tile_scan(tile);
+		pthread_barrier_wait(&tiles->barrier);
 	}
-	free(sp);
+
+	return NULL;
 }
 
-static ca_t **ca_space_alloc(int hight, int length)
+/* the first tile is scanned by the calling thread, one worker is started
+ * for each of the others. should fewer workers start, fewer tiles are used */
+static int ca_tiles_alloc(ca_space_t *s, int num)
 {
-	ca_t **sp;
+	ca_tiles_t *tiles;
 	int i;
 
-	if (!(sp = calloc(hight, sizeof(ca_t *))))
-		return NULL;
+	if (!(tiles = calloc(1, sizeof(ca_tiles_t))))
+		return -1;
+	s->tiles = tiles;
 
-	for (i = 0; i < hight && (sp[i] = ca_alloc(length)); i++);
+	if (!(tiles->tile = calloc(num, sizeof(ca_tile_t))) ||
+		!(tiles->threads = calloc(num - 1, sizeof(pthread_t)))) {
+		return -1;
+	}
+	for (i = 0; i < num; i++)
+		tiles->tile[i].space = s;
+	tiles->cells_min = s->cb->tile_cells_min ? s->cb->tile_cells_min :
+		TILE_CELLS_MIN;
+
+	pthread_mutex_init(&tiles->lock, NULL);
+	pthread_mutex_lock(&tiles->lock);
+	for (i = 0; i < num - 1; i++) {
+		if (pthread_create(&tiles->threads[i], NULL, tile_thread,
+			&tiles->tile[i + 1])) {
+			break;
+		}
+	}
+	tiles->thread_num = i;
+	tiles->num = i + 1;
+	pthread_barrier_init(&tiles->barrier, NULL, tiles->num);
+	tiles->is_init = 1;
+	pthread_mutex_unlock(&tiles->lock);
 
-	if (i < hight)
-		goto Error;
+	return 0;
+}
 
-	for (i = 0; i < hight; i++) {
-		int j;
+static void ca_tiles_free(ca_space_t *s)
+{
+	ca_tiles_t *tiles = s->tiles;
+	int i;
 
-		for (j = 0; j < length; j++) {
-			wind_dir_t dir;
+	if (!tiles)
+		return;
 
-			for (dir = DIR_NO; dir <= DIR_NW; dir++) {
-				coordinate_euclid_t cell, neighbour;
+	if (tiles->is_init) {
+		tiles->is_done = 1;
+		pthread_barrier_wait(&tiles->barrier);
+		for (i = 0; i < tiles->thread_num; i++)
+			pthread_join(tiles->threads[i], NULL);
+		pthread_barrier_destroy(&tiles->barrier);
+		pthread_mutex_destroy(&tiles->lock);
+	}
 
-				cell.n = i;
-				cell.m = j;
-				coordinate_moore_neighbour(hight, length, &cell,
-					dir, &neighbour);
-				sp[i][j].neighbours[dir] =
-					&sp[neighbour.n][neighbour.m];
-			}
+	if (tiles->tile) {
+		for (i = 0; i < tiles->num; i++)
+			free(tiles->tile[i].ops);
+	}
+	free(tiles->tile);
+	free(tiles->threads);
+	free(tiles);
+	s->tiles = NULL;
+}
+
+static void ca_space_free(ca_space_t *s)
+{
+	int i;
+
+	ca_tiles_free(s);
+
+	if (s->blocks) {
+		for (i = 0; i < s->block_dir_sz; i++) {
+			ca_block_t *blk = s->blocks[i];
+			int j;
+
+			if (!blk)
+				continue;
+
+			for (j = 0; j < BLOCK_CELLS; j++)
+				free(blk->mons[j]);
+			free(blk);
 		}
 	}
+	if (s->block_spare) {
+		for (i = 0; i < BLOCK_CELLS; i++)
+			free(s->block_spare->mons[i]);
+	}
+	free(s->block_spare);
+	free(s->block_quiet);
+	free(s->blocks);
+	free(s->scan_map);
+	free(s->scan_map_next);
+	free(s->dirty);
+}
+
+/* a synchronously stepped space keeps the cells to scan as bitmaps over the
+ * cells' indices rather than as events */
+static int ca_space_sync_alloc(ca_space_t *s, int num)
+{
+	s->scan_map_words = (num + SCAN_MAP_WORD_BITS - 1) / SCAN_MAP_WORD_BITS;
+	s->scan_map = calloc(s->scan_map_words, sizeof(unsigned long));
+	s->scan_map_next = calloc(s->scan_map_words, sizeof(unsigned long));
+
+	return s->scan_map && s->scan_map_next ? 0 : -1;
+}
+
+/* the space is a torus laid out in blocks. a cell's neighbours are found at
+ * the same handle offsets all over it, but for the cells on a block's border
+ * or on the space's border whose neighbours are looked up by coordinates
+ * instead. only the blocks' table is allocated for the whole space, a block
+ * holding its cells' handles and fields is allocated once one of its cells
+ * is looked up. the quiet block's cells are only ever read, standing in for
+ * those of the blocks not allocated, the spare block's are written instead
+ * of those of a block which could not be allocated. on failure, whatever was
+ * allocated is freed by sat_error_handler() */
+static int ca_space_alloc(ca_space_t *s)
+{
+	int num;
+	coordinate_euclid_t cell, neighbour;
+	wind_dir_t dir;
+
+	s->block_dim = (s->sp_dim + BLOCK_DIM - 1) / BLOCK_DIM;
+	s->block_dir_sz = s->block_dim * s->block_dim;
+	num = s->block_dir_sz * BLOCK_CELLS;
+	s->rd = 0;
+	s->wr = s->cb->is_sync ? 1 : 0;
+
+	s->blocks = calloc(s->block_dir_sz, sizeof(ca_block_t *));
+	s->block_quiet = block_new(s, 0);
+	s->block_spare = block_new(s, 0);
+	if (!s->blocks || !s->block_quiet || !s->block_spare)
+		return -1;
+	/* none of the spare block's cells may be stepped from to another */
+	s->block_spare->row_max = 0;
+	s->block_spare->col_max = 0;
 
-	return sp;
+	if (s->cb->is_sync && (ca_space_sync_alloc(s, num) ||
+		(s->cb->sync_threads > 1 &&
+		ca_tiles_alloc(s, s->cb->sync_threads)))) {
+		return -1;
+	}
 
-Error:
-	ca_space_free(sp, i, length);
-	return NULL;
+	cell.n = 1;
+	cell.m = 1;
+	for (dir = DIR_NO; dir <= DIR_NW; dir++) {
+		coordinate_moore_neighbour(s->sp_dim, s->sp_dim, &cell, dir,
+			&neighbour);
+		s->nei_offsets[dir] = sp_idx(s, neighbour.n, neighbour.m) -
+			sp_idx(s, cell.n, cell.m);
+	}
+
+	return 0;
+}
+
+static ca_t *sp_cell(ca_space_t *s, int i, int j)
+{
+	return sp_cell_idx(s, sp_idx(s, i, j));
+}
+
+/* the cell at i, j if its block is allocated, or the quiet block's cell in
+ * its stead. to be printed, never written */
+static ca_t *sp_cell_read(ca_space_t *s, int i, int j)
+{
+	int idx = sp_idx(s, i, j);
+	ca_block_t *blk = s->blocks[BLOCK_IDX(idx)];
+
+	return &(blk ? blk : s->block_quiet)->cells[BLOCK_OFF(idx)];
 }
 
 static int sp_dim_get(int var_num)
@@ -473,33 +1123,37 @@ static int sp_dim_get(int var_num)
 
 static void sp_uninit(ca_space_t *s)
 {
-	ca_space_free(s->sp, s->sp_dim, s->sp_dim);
+	ca_space_free(s);
 }
 
 static int is_bound(ca_t *ca)
 {
-	return ca->dir != DR_QUIESCENT;
+	return CA_DIR(ca) != DR_QUIESCENT;
 }
 
 static void sat_event_loop_clear(void *o)
 {
 	ca_space_t *s = (ca_space_t *)o;
-	int i;
-
-	/* delete all calls to CAs in the event loop */
-	for (i = 0; i < s->sp_dim; i++) {
-		int j;
+	int i, j;
 
-		for (j = 0; j < s->sp_dim; j++) {
-			ca_t *ca = &s->sp[i][j];
+	/* delete all calls to CAs and to their monitors in the event loop. a
+	 * run cut short may still have arms growing through unbound cells. no
+	 * event refers to a cell whose block is not allocated */
+	for (i = 0; i < s->block_dir_sz; i++) {
+		if (!s->blocks[i])
+			continue;
 
-			if (is_bound(ca))
-				event_del_all(ca);
-		}
+		for (j = 0; j < BLOCK_CELLS; j++)
+			event_del_all(&s->blocks[i]->cells[j]);
 	}
+	for (j = 0; j < BLOCK_CELLS; j++)
+		event_del_all(&s->block_spare->cells[j]);
+
+	/* delete the synchronous engine's next step */
+	event_del_all(s);
 
 	/* delete the call to the printing function */
-	event_del_once(s);
+	event_del_timer(s);
 }
 
 static void sat_error_handler(void *o)
@@ -520,15 +1174,15 @@ static void sat_success_handler(void *o)
 
 static int monitor_offset_get(ca_t *ca)
 {
-	ca_t *nei = pointing_neighbour(ca);
+	monitor_t *mon = CA_MON(pointing_neighbour(ca));
 
-	return nei->mon.offset ? nei->mon.offset + 1 : 1;
+	return mon && mon->offset ? mon->offset + 1 : 1;
 }
 
-static int monitor_pos_tbl_sz_get(int offset)
+static int monitor_pos_tbl_sz_get(ca_space_t *s, int offset)
 {
-	int p = clause_num / loop_len;
-	int q = clause_num - p * loop_len;
+	int p = s->clause_num / s->loop_len;
+	int q = s->clause_num - p * s->loop_len;
 
 	return p + (offset <= q ? 1 : 0);
 }
@@ -537,14 +1191,14 @@ static void mon_spread_do(void *o)
 {
 	ca_t *ca = (ca_t *)o;
 	int offset = monitor_offset_get(ca);
-	int pos_tbl_sz = monitor_pos_tbl_sz_get(offset);
-	ca_t *nei_ahead = ca->neighbours[cadir2dir(ca->dir)];
+	int pos_tbl_sz = monitor_pos_tbl_sz_get(CA_SPACE(ca), offset);
+	ca_t *nei_ahead = ca_neighbour(ca, cadir2dir(CA_DIR(ca)));
 	ca_t *nei_left =
-		ca->neighbours[wind_dir_offset(cadir2dir(ca->dir), -2)];
+		ca_neighbour(ca, wind_dir_offset(cadir2dir(CA_DIR(ca)), -2));
 	ca_t *ca_propogate = is_bound(nei_left) &&
 		pointing_neighbour(nei_left) == ca ? nei_left : nei_ahead;
 
-	if (mon_init(&(ca->mon), offset, pos_tbl_sz))
+	if (mon_init(ca, offset, pos_tbl_sz))
 		error_set();
 	else
 		event_add_once(mon_spread_scan, ca_propogate);
@@ -555,23 +1209,25 @@ static void mon_spread_scan(void *o)
 	ca_t *ca = (ca_t *)o;
 	ca_direction_t sw_dir, sw_dir_bad;
 
-	if (ca->flag == FL_ERASE_LOOP)
+	if (CA_FLAG(ca) == FL_ERASE_LOOP)
 		return;
 
 	if (!is_bound(ca) ||
-		(!is_bound(ca->neighbours[wind_dir_offset(cadir2dir(ca->dir),
-		-2)]) && !is_bound(ca->neighbours[cadir2dir(ca->dir)]))) {
+		(!is_bound(ca_neighbour(ca,
+		wind_dir_offset(cadir2dir(CA_DIR(ca)), -2))) &&
+		!is_bound(ca_neighbour(ca, cadir2dir(CA_DIR(ca)))))) {
 		/* if the cell is not bound or neither the cell ahead of it
 		 * and the cell to its left are bound initiate rescanning */
 		event_add(mon_spread_init_phase2, o);
 		return;
 	}
 
-	sw_dir = ca->neighbours[wind_dir_offset(cadir2dir(ca->dir), -3)]->dir;
-	sw_dir_bad = dir2cadir(wind_dir_offset(cadir2dir(ca->dir), -2));
+	sw_dir = CA_DIR(ca_neighbour(ca,
+		wind_dir_offset(cadir2dir(CA_DIR(ca)), -3)));
+	sw_dir_bad = dir2cadir(wind_dir_offset(cadir2dir(CA_DIR(ca)), -2));
 
-	if (ca->mon.pos_tbl || sw_dir == sw_dir_bad ||
-		!monitor_pos_tbl_sz_get(monitor_offset_get(ca))) {
+	if (CA_MON(ca) || sw_dir == sw_dir_bad ||
+		!monitor_pos_tbl_sz_get(CA_SPACE(ca), monitor_offset_get(ca))) {
 		/* do not spread a monitor to the cell if:
 		 * - it has already been spread
 		 * - the cell is connecting a loop to its replicate
@@ -591,7 +1247,8 @@ static void mon_spread_init_phase2_set(void *o)
 {
 	ca_t *ca = (ca_t *)o;
 
-	event_add(mon_spread_init_phase2, ca->neighbours[cadir2dir(ca->dir)]);
+	event_add(mon_spread_init_phase2,
+		ca_neighbour(ca, cadir2dir(CA_DIR(ca))));
 }
 
 static void mon_spread_init_phase1(void *o)
@@ -601,59 +1258,62 @@ static void mon_spread_init_phase1(void *o)
 
 static void mon_spread_init_phase1_set(ca_t *ca)
 {
-	event_add(mon_spread_init_phase1, ca);
+	ca_event_add(mon_spread_init_phase1, ca);
 }
 
-static int is_mon_danger(monitor_t *mon, int pos, int distance)
+static int is_mon_danger(table_t *table, monitor_t *mon, int pos,
+	int distance)
 {
 	return table ? mon->pos_tbl[pos] == (table->record_num - distance) : 0;
 }
 
-static int is_mon_fail(monitor_t *mon, int pos)
+static int is_mon_fail(table_t *table, monitor_t *mon, int pos)
 {
-	return is_mon_danger(mon, pos, 1);
+	return is_mon_danger(table, mon, pos, 1);
 }
 
-static int is_mon_allert(monitor_t *mon, int pos)
+static int is_mon_allert(table_t *table, monitor_t *mon, int pos)
 {
-	return is_mon_danger(mon, pos, 2);
+	return is_mon_danger(table, mon, pos, 2);
 }
 
-static ca_monitor_state_t mon_scan(monitor_t *mon, int id, ca_code_t code)
+static ca_monitor_state_t mon_scan(ca_space_t *s, monitor_t *mon, int id,
+	ca_code_t code)
 {
+	table_t *table = s->table;
 	int i;
 	ca_monitor_state_t status = MN_NOOP;
 
-	if (!mon->is_active)
+	if (!mon || !mon->is_active)
 		goto Exit;
 
 	for (i = 0; i < mon->pos_tbl_sz; i++) {
-		int clause = mon->offset + i*loop_len;
+		int clause = mon->offset + i*s->loop_len;
+		int pos = mon->pos_tbl[i], lit_id;
+		sat_tv_t lit_tv;
 
-		if (mon->pos_tbl[i] == -1)
+		if (pos == -1)
 			continue;
 
-		if (!table->t[mon->pos_tbl[i]][clause].id &&
-			table->t[mon->pos_tbl[i]][clause].tv ==
-			SAT_TV_TAUTOLOGY) {
+		lit_id = TABLE_ID(table, pos, clause);
+		lit_tv = TABLE_TV(table, pos, clause);
+		if (!lit_id && lit_tv == SAT_TV_TAUTOLOGY)
 			return MN_FAIL;
-		}
 
-		if (table->t[mon->pos_tbl[i]][clause].id != id)
+		if (lit_id != id)
 			continue;
 
-		if (table->t[mon->pos_tbl[i]][clause].tv == SAT_TV_PARADOX ||
-			table->t[mon->pos_tbl[i]][clause].tv !=
-			code2code(truth_values, code)) {
+		if (lit_tv == SAT_TV_PARADOX ||
+			lit_tv != code2code(truth_values, code)) {
 			if (code == CD_ZERO || code == CD_ONE)
 				mon->pos_tbl[i] = -1;
 			continue;
 		}
 
-		if (is_mon_fail(mon, i))
+		if (is_mon_fail(table, mon, i))
 			return MN_FAIL;
 
-		status = is_mon_allert(mon, i) ? MN_ALLERT : MN_ACTIVE;
+		status = is_mon_allert(table, mon, i) ? MN_ALLERT : MN_ACTIVE;
 		mon->pos_tbl[i]++;
 	}
 
@@ -676,7 +1336,8 @@ static int is_neighbour_degenerate(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->neighbours[cadir2dir(X)]->flag == FL_ERASE_LOOP);
+	ROTATE(dir, ca, CA_FLAG(ca_neighbour(ca, cadir2dir(X))) ==
+		FL_ERASE_LOOP);
 	return dir == DR_UNDEFINED ? 0 : 1;
 }
 
@@ -685,8 +1346,8 @@ static ca_flag_t is_replicate_arm_retract(ca_t *ca)
 	ca_direction_t dir;
 
 	/* X is the rotating ca_direction_t */
-	ROTATE(dir, ca, ca->neighbours[cadir2dir(X)]->dir == X &&
-		ca->neighbours[cadir2dir(X)]->flag == FL_COLLISION);
+	ROTATE(dir, ca, CA_DIR(ca_neighbour(ca, cadir2dir(X))) == X &&
+		CA_FLAG(ca_neighbour(ca, cadir2dir(X))) == FL_COLLISION);
 
 	return dir;
 }
@@ -695,8 +1356,9 @@ static int is_replication_complete(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->neighbours[cadir2dir(X)]->code == CD_DETACH ||
-		ca->neighbours[cadir2dir(dir_opposite(X))]->code == CD_DETACH);
+	ROTATE(dir, ca, CA_CODE(ca_neighbour(ca, cadir2dir(X))) == CD_DETACH ||
+		CA_CODE(ca_neighbour(ca, cadir2dir(dir_opposite(X)))) ==
+		CD_DETACH);
 
 	return dir == DR_UNDEFINED ? 0 : 1;
 }
@@ -705,8 +1367,9 @@ static int is_arm_extrusion_failure(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->dir == X && !ca->neighbours[cadir2dir(X)]->dir &&
-		ca->neighbours[wind_dir_offset(cadir2dir(X), -2)]->code ==
+	ROTATE(dir, ca, CA_DIR(ca) == X &&
+		!CA_DIR(ca_neighbour(ca, cadir2dir(X))) &&
+		CA_CODE(ca_neighbour(ca, wind_dir_offset(cadir2dir(X), -2))) ==
 		CD_FLOW);
 
 	return dir == DR_UNDEFINED ? 0 : 1;
@@ -715,42 +1378,42 @@ static int is_arm_extrusion_failure(ca_t *ca)
 /* flag setting functions */
 static void flag_set_queiscent(void *o)
 {
-	((ca_t *)o)->flag = FL_QUIESCENT;
+	CA_SET((ca_t *)o, FLAG, FL_QUIESCENT);
 }
 
 static void flag_set_erase_loop(void *o)
 {
-	((ca_t *)o)->flag = FL_ERASE_LOOP;
+	CA_SET((ca_t *)o, FLAG, FL_ERASE_LOOP);
 }
 
 static void flag_set_collision(void *o)
 {
-	((ca_t *)o)->flag = FL_COLLISION;
+	CA_SET((ca_t *)o, FLAG, FL_COLLISION);
 }
 
 static void flag_set_branch_seq(void *o)
 {
-	((ca_t *)o)->flag = FL_BRANCH_SEQ;
+	CA_SET((ca_t *)o, FLAG, FL_BRANCH_SEQ);
 }
 
 static void flag_set_gen_zero(void *o)
 {
-	((ca_t *)o)->flag = FL_GEN_ZERO;
+	CA_SET((ca_t *)o, FLAG, FL_GEN_ZERO);
 }
 
 static void flag_set_gen_one(void *o)
 {
-	((ca_t *)o)->flag = FL_GEN_ONE;
+	CA_SET((ca_t *)o, FLAG, FL_GEN_ONE);
 }
 
 static void flag_set_monitor_active(void *o)
 {
-	((ca_t *)o)->flag = FL_MONITOR_ACTIVE;
+	CA_SET((ca_t *)o, FLAG, FL_MONITOR_ACTIVE);
 }
 
 static void flag_set_monitor_allert(void *o)
 {
-	((ca_t *)o)->flag = FL_MONITOR_ALLERT;
+	CA_SET((ca_t *)o, FLAG, FL_MONITOR_ALLERT);
 }
 
 static void flag_set(ca_t *ca, ca_flag_t flag)
@@ -787,7 +1450,7 @@ static void flag_set(ca_t *ca, ca_flag_t flag)
 		return;
 	}
 
-	event_add(func, ca);
+	ca_write(ca, func);
 }
 
 /* flags scanning function */
@@ -796,16 +1459,16 @@ static void flags_scan(ca_t *ca)
 	ca_direction_t dir;
 
 	/* if any of the destruction flags are set reset the flag */
-	if (is_flag_degenerate(ca->flag)) {
+	if (is_flag_degenerate(CA_FLAG(ca))) {
 		flag_set(ca, FL_QUIESCENT);
-		if (ca->loop)
-			loop_fail_set(ca->loop);
+		if (CA_LOOP(ca))
+			ca_call(loop_fail_set, CA_LOOP(ca));
 		return;
 	}
 
 	/* if ca is bound and there is a destruction flag nearby, set the
 	 * destruction flag */
-	if (ca->dir && is_neighbour_degenerate(ca)) {
+	if (CA_DIR(ca) && is_neighbour_degenerate(ca)) {
 		flag_set(ca, FL_ERASE_LOOP);
 		return;
 	}
@@ -816,7 +1479,7 @@ static void flags_scan(ca_t *ca)
 	if (dir != DR_UNDEFINED) {
 		wind_dir_t side = wind_dir_offset(cadir2dir(dir), -2);
 
-		if (ca->neighbours[side]->dir == dir)
+		if (CA_DIR(ca_neighbour(ca, side)) == dir)
 			flag_set(ca, FL_BRANCH_SEQ);
 		else
 			flag_set(ca, FL_COLLISION);
@@ -825,7 +1488,7 @@ static void flags_scan(ca_t *ca)
 
 	/* if the replication arm is closing on itself set the flag to mutate a
 	 * new one bit */
-	if (ca->code && ca->flag & (FL_QUIESCENT | FL_MONITOR_ACTIVE |
+	if (CA_CODE(ca) && CA_FLAG(ca) & (FL_QUIESCENT | FL_MONITOR_ACTIVE |
 		FL_MONITOR_ALLERT) && is_replication_complete(ca)) {
 		flag_set(ca, FL_GEN_ZERO);
 		return;
@@ -834,44 +1497,45 @@ static void flags_scan(ca_t *ca)
 	/* arm extrusion failure checking. a failed attempt at new arm
 	 * extrusion will result in the FL_BRANCH_SEQ flag being set in the
 	 * corner. this allows further attempts at the other directions later */
-	if (ca->code == CD_ARM_EXT_END && is_arm_extrusion_failure(ca)) {
+	if (CA_CODE(ca) == CD_ARM_EXT_END && is_arm_extrusion_failure(ca)) {
 		flag_set(ca, FL_BRANCH_SEQ);
 		return;
 	}
 
 	/* change FL_GEN_ZERO to FL_GEN_ONE after seeing a CD_TURN_LEFT in
 	 * order to mutate a new one bit */
-	if (ca->flag == FL_GEN_ZERO && ca->code == CD_TURN_LEFT) {
+	if (CA_FLAG(ca) == FL_GEN_ZERO && CA_CODE(ca) == CD_TURN_LEFT) {
 		flag_set(ca, FL_GEN_ONE);
 		return;
 	}
 
 	/* CD_ARM_EXT_START always clears the flag */
-	if (ca->code == CD_ARM_EXT_START) {
+	if (CA_CODE(ca) == CD_ARM_EXT_START) {
 		flag_set(ca, FL_QUIESCENT);
 		return;
 	}
 
 	/* reset FL_GEN_ONE/FL_GEN_ZERO to either FL_QUIESCENT or
 	 * FL_BRANCH_SEQ */
-	if (ca->flag & (FL_GEN_ZERO | FL_GEN_ONE)) {
-		if (pointing_neighbour(ca)->code == CD_FLOW) {
+	if (CA_FLAG(ca) & (FL_GEN_ZERO | FL_GEN_ONE)) {
+		if (CA_CODE(pointing_neighbour(ca)) == CD_FLOW) {
 			flag_set(ca, FL_QUIESCENT);
 			return;
 		}
 
-		if (ca->code == CD_UNEXPLORED_0 ||
-			ca->code == CD_UNEXPLORED_1) {
+		if (CA_CODE(ca) == CD_UNEXPLORED_0 ||
+			CA_CODE(ca) == CD_UNEXPLORED_1) {
 			flag_set(ca, FL_BRANCH_SEQ);
 			return;
 		}
 	}
 
-	if (ca->id) {
-		switch (mon_scan(&ca->mon, ca->id, ca->code))
+	if (CA_ID(ca)) {
+		switch (mon_scan(CA_SPACE(ca), CA_MON(ca), CA_ID(ca),
+			CA_CODE(ca)))
 		{
 		case MN_SUCCESS:
-			mon_deactivate_set(&ca->mon);
+			mon_deactivate_set(ca);
 			break;
 		case MN_ACTIVE:
 			flag_set(ca, FL_MONITOR_ACTIVE);
@@ -893,93 +1557,93 @@ static void flags_scan(ca_t *ca)
 /* code set functions */
 static void code_set_quiescent(void *o)
 {
-	((ca_t *)o)->code = CD_QUIESCENT;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_QUIESCENT);
+	ca_scan_set(o);
 }
 
 static void code_set_flow(void *o)
 {
-	((ca_t *)o)->code = CD_FLOW;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_FLOW);
+	ca_scan_set(o);
 }
 
 static void code_set_grow(void *o)
 {
 	ca_t *ca = (ca_t *)o;
-	ca_t *nei_ahead = ca->neighbours[cadir2dir(ca->dir)];
+	ca_t *nei_ahead = ca_neighbour(ca, cadir2dir(CA_DIR_W(ca)));
 
-	ca->code = CD_GROW;
-	event_add_once(ca_scan, ca);
-	event_add_once(ca_scan, nei_ahead);
+	CA_SET(ca, CODE, CD_GROW);
+	ca_scan_set(ca);
+	ca_scan_set(nei_ahead);
 }
 
 static void code_set_turn_left(void *o)
 {
 	ca_t *ca = (ca_t *)o;
-	ca_t *nei_left = ca->neighbours[wind_dir_offset(cadir2dir(ca->dir),
-		-2)];
+	ca_t *nei_left = ca_neighbour(ca,
+		wind_dir_offset(cadir2dir(CA_DIR_W(ca)), -2));
 
-	ca->code = CD_TURN_LEFT;
-	event_add_once(ca_scan, ca);
-	event_add_once(ca_scan, nei_left);
+	CA_SET(ca, CODE, CD_TURN_LEFT);
+	ca_scan_set(ca);
+	ca_scan_set(nei_left);
 }
 
 static void code_set_arm_ext_start(void *o)
 {
 	ca_t *ca = (ca_t *)o;
-	ca_t *nei_ahead = ca->neighbours[cadir2dir(ca->dir)];
+	ca_t *nei_ahead = ca_neighbour(ca, cadir2dir(CA_DIR_W(ca)));
 
-	ca->code = CD_ARM_EXT_START;
-	event_add_once(ca_scan, ca);
-	event_add_once(ca_scan, nei_ahead);
+	CA_SET(ca, CODE, CD_ARM_EXT_START);
+	ca_scan_set(ca);
+	ca_scan_set(nei_ahead);
 }
 
 static void code_set_arm_ext_end(void *o)
 {
-	((ca_t *)o)->code = CD_ARM_EXT_END;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_ARM_EXT_END);
+	ca_scan_set(o);
 }
 
 static void code_set_detach(void *o)
 {
-	((ca_t *)o)->code = CD_DETACH;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_DETACH);
+	ca_scan_set(o);
 }
 
 static void code_set_unexplored_0(void *o)
 {
-	((ca_t *)o)->code = CD_UNEXPLORED_0;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_UNEXPLORED_0);
+	ca_scan_set(o);
 }
 
 static void code_set_unexplored_1(void *o)
 {
-	((ca_t *)o)->code = CD_UNEXPLORED_1;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_UNEXPLORED_1);
+	ca_scan_set(o);
 }
 
 static void code_set_zero(void *o)
 {
-	((ca_t *)o)->code = CD_ZERO;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_ZERO);
+	ca_scan_set(o);
 }
 
 static void code_set_one(void *o)
 {
-	((ca_t *)o)->code = CD_ONE;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_ONE);
+	ca_scan_set(o);
 }
 
 static void code_set_tautology(void *o)
 {
-	((ca_t *)o)->code = CD_TAUTOLOGY;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_TAUTOLOGY);
+	ca_scan_set(o);
 }
 
 static void code_set_paradox(void *o)
 {
-	((ca_t *)o)->code = CD_PARADOX;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, CODE, CD_PARADOX);
+	ca_scan_set(o);
 }
 
 static void code_set(ca_t *ca, ca_code_t code)
@@ -1031,37 +1695,37 @@ static void code_set(ca_t *ca, ca_code_t code)
 		return;
 	}
 
-	event_add(func, ca);
+	ca_write(ca, func);
 }
 
 /* direction set functions */
 static void dir_set_quiescent(void *o)
 {
-	((ca_t *)o)->dir = DR_QUIESCENT;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, DIR, DR_QUIESCENT);
+	ca_scan_set(o);
 }
 
 static void dir_set_up(void *o)
 {
-	((ca_t *)o)->dir = DR_UP;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, DIR, DR_UP);
+	ca_scan_set(o);
 }
 
 static void dir_set_down(void *o)
 {
-	((ca_t *)o)->dir = DR_DOWN;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, DIR, DR_DOWN);
+	ca_scan_set(o);
 }
 
 static void dir_set_left(void *o)
 {
-	((ca_t *)o)->dir = DR_LEFT;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, DIR, DR_LEFT);
+	ca_scan_set(o);
 }
 
 static void dir_set_right(void *o)
 {
-	((ca_t *)o)->dir = DR_RIGHT;
+	CA_SET((ca_t *)o, DIR, DR_RIGHT);
 }
 
 static void dir_set(ca_t *ca, ca_direction_t dir)
@@ -1089,38 +1753,38 @@ static void dir_set(ca_t *ca, ca_direction_t dir)
 		return;
 	}
 
-	event_add(func, ca);
+	ca_write(ca, func);
 }
 
 /* colour set functions */
 static void col_set_quiescent(void *o)
 {
-	((ca_t *)o)->col = CL_QUIESCENT;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, COL, CL_QUIESCENT);
+	ca_scan_set(o);
 }
 
 static void col_set_white(void *o)
 {
-	((ca_t *)o)->col = CL_WHITE;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, COL, CL_WHITE);
+	ca_scan_set(o);
 }
 
 static void col_set_yellow(void *o)
 {
-	((ca_t *)o)->col = CL_YELLOW;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, COL, CL_YELLOW);
+	ca_scan_set(o);
 }
 
 static void col_set_blue(void *o)
 {
-	((ca_t *)o)->col = CL_BLUE;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, COL, CL_BLUE);
+	ca_scan_set(o);
 }
 
 static void col_set_red(void *o)
 {
-	((ca_t *)o)->col = CL_RED;
-	event_add_once(ca_scan, o);
+	CA_SET((ca_t *)o, COL, CL_RED);
+	ca_scan_set(o);
 }
 
 static void col_set(ca_t *ca, ca_code_t col)
@@ -1148,56 +1812,56 @@ static void col_set(ca_t *ca, ca_code_t col)
 		return;
 	}
 
-	event_add(func, ca);
+	ca_write(ca, func);
 }
 
 static void id_reset(void *o)
 {
-	((ca_t *)o)->id = ID_UNDEFINED;
-	event_add_once(ca_scan, o);
+	ca_id_set((ca_t *)o, ID_UNDEFINED);
+	ca_scan_set(o);
 }
 
 static void id_inc(void *o)
 {
-	((ca_t *)o)->id++;
-	event_add_once(ca_scan, o);
+	ca_id_set((ca_t *)o, CA_ID((ca_t *)o) + 1);
+	ca_scan_set(o);
 }
 
 static int is_code(ca_t *ca)
 {
-	return ca->code != CD_QUIESCENT;
+	return CA_CODE(ca) != CD_QUIESCENT;
 }
 
 static int is_code_detach(ca_t *ca)
 {
-	return ca->code == CD_DETACH;
+	return CA_CODE(ca) == CD_DETACH;
 }
 
 static int is_code_arm_ext_start(ca_t *ca)
 {
-	return ca->code == CD_ARM_EXT_START;
+	return CA_CODE(ca) == CD_ARM_EXT_START;
 }
 
 static int is_code_unexplored_0(ca_t *ca)
 {
-	return ca->code == CD_UNEXPLORED_0;
+	return CA_CODE(ca) == CD_UNEXPLORED_0;
 }
 
 static int is_code_unexplored_1(ca_t *ca)
 {
-	return ca->code == CD_UNEXPLORED_1;
+	return CA_CODE(ca) == CD_UNEXPLORED_1;
 }
 
 static int is_pointing_neighbour_grow(ca_t *ca)
 {
-	return pointing_neighbour(ca)->code == CD_GROW;
+	return CA_CODE(pointing_neighbour(ca)) == CD_GROW;
 }
 
 static int is_destruct_detach(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->neighbours[cadir2dir(X)]->flag == FL_GEN_ZERO);
+	ROTATE(dir, ca, CA_FLAG(ca_neighbour(ca, cadir2dir(X))) == FL_GEN_ZERO);
 	return dir == DR_UNDEFINED ? 0 : 1;
 
 }
@@ -1206,38 +1870,38 @@ static int is_loop_close(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->dir == X &&
-		ca->neighbours[wind_dir_offset(cadir2dir(X), -3)]->dir ==
+	ROTATE(dir, ca, CA_DIR(ca) == X &&
+		CA_DIR(ca_neighbour(ca, wind_dir_offset(cadir2dir(X), -3))) ==
 		dir2cadir(wind_dir_offset(cadir2dir(X), -2)) &&
-		ca->neighbours[wind_dir_offset(cadir2dir(X), -3)]->code !=
+		CA_CODE(ca_neighbour(ca, wind_dir_offset(cadir2dir(X), -3))) !=
 		CD_QUIESCENT &&
-		ca->neighbours[wind_dir_offset(cadir2dir(X), -1)]->dir ==
+		CA_DIR(ca_neighbour(ca, wind_dir_offset(cadir2dir(X), -1))) ==
 		dir2cadir(wind_dir_offset(cadir2dir(X), 2)) &&
-		ca->neighbours[wind_dir_offset(cadir2dir(X), -1)]->code !=
+		CA_CODE(ca_neighbour(ca, wind_dir_offset(cadir2dir(X), -1))) !=
 		CD_QUIESCENT);
 	return dir == DR_UNDEFINED ? 0 : 1;
 }
 
 static int is_pointing_neighbour_detach(ca_t *ca)
 {
-	return pointing_neighbour(ca)->code == CD_DETACH;
+	return CA_CODE(pointing_neighbour(ca)) == CD_DETACH;
 }
 
 static int is_gen_arm_extention(ca_t *ca)
 {
-	return ca->code != CD_FLOW && ca->code != CD_ARM_EXT_START &&
-		ca->flag == FL_BRANCH_SEQ && pointing_neighbour(ca)->code ==
-		CD_FLOW;
+	return CA_CODE(ca) != CD_FLOW && CA_CODE(ca) != CD_ARM_EXT_START &&
+		CA_FLAG(ca) == FL_BRANCH_SEQ &&
+		CA_CODE(pointing_neighbour(ca)) == CD_FLOW;
 }
 
 static int is_arm_ext_start_corner(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->dir == X && pointing_neighbour(ca)->code ==
-		CD_ARM_EXT_START && cadir2dir(pointing_neighbour(ca)->dir) ==
-		wind_dir_offset(cadir2dir(ca->dir), 2) &&
-		pointing_neighbour(pointing_neighbour(ca))->code ==
+	ROTATE(dir, ca, CA_DIR(ca) == X && CA_CODE(pointing_neighbour(ca)) ==
+		CD_ARM_EXT_START && cadir2dir(CA_DIR(pointing_neighbour(ca))) ==
+		wind_dir_offset(cadir2dir(CA_DIR(ca)), 2) &&
+		CA_CODE(pointing_neighbour(pointing_neighbour(ca))) ==
 		CD_ARM_EXT_END);
 
 	return dir == DR_UNDEFINED ? 0 : 1;
@@ -1245,31 +1909,31 @@ static int is_arm_ext_start_corner(ca_t *ca)
 
 static int is_arm_ext_end_corner(ca_t *ca)
 {
-	return ca->code == CD_FLOW && pointing_neighbour(ca)->code ==
+	return CA_CODE(ca) == CD_FLOW && CA_CODE(pointing_neighbour(ca)) ==
 		CD_ARM_EXT_END;
 }
 
 static int is_flag_gen_zero(ca_t *ca)
 {
-	return ca->flag == FL_GEN_ZERO;
+	return CA_FLAG(ca) == FL_GEN_ZERO;
 }
 
 static int is_flag_gen_one(ca_t *ca)
 {
-	return ca->flag == FL_GEN_ONE;
+	return CA_FLAG(ca) == FL_GEN_ONE;
 }
 
 static void id_set(ca_t *ca, int id)
 {
-	if (id == ca->id)
+	if (id == CA_ID(ca))
 		return;
 
-	event_add(id == ca->id + 1 ? id_inc : id_reset, ca);
+	ca_write(ca, id == CA_ID(ca) + 1 ? id_inc : id_reset);
 }
 
 static void set_scan(void *o)
 {
-	event_add_once(ca_scan, o);
+	ca_scan_set(o);
 }
 
 static void bound_rules_scan(ca_t *ca)
@@ -1277,7 +1941,7 @@ static void bound_rules_scan(ca_t *ca)
 	ca_t *neighbour = pointing_neighbour(ca);
 
 	/* if any of the destruction flags is set, reset all fields */
-	if (is_flag_degenerate(ca->flag)) {
+	if (is_flag_degenerate(CA_FLAG(ca))) {
 		code_set(ca, CD_QUIESCENT);
 		dir_set(ca, DR_QUIESCENT);
 		col_set(ca, CL_QUIESCENT);
@@ -1291,7 +1955,7 @@ static void bound_rules_scan(ca_t *ca)
 		if (is_pointing_neighbour_grow(ca))
 			code_set(ca, CD_FLOW);
 		else
-			event_add(set_scan, ca);
+			ca_write(ca, set_scan);
 		return;
 	}
 
@@ -1313,10 +1977,9 @@ static void bound_rules_scan(ca_t *ca)
 	/* close the child loop */
 	if (is_pointing_neighbour_detach(ca)) {
 		ca_direction_t dir =
-			dir2cadir(wind_dir_offset(cadir2dir(ca->dir), 2));
-		ca_code_t code =
-			ca->neighbours[wind_dir_offset(cadir2dir(ca->dir),
-			-2)]->code;
+			dir2cadir(wind_dir_offset(cadir2dir(CA_DIR(ca)), 2));
+		ca_code_t code = CA_CODE(ca_neighbour(ca,
+			wind_dir_offset(cadir2dir(CA_DIR(ca)), -2)));
 
 		dir_set(ca, dir);
 		code_set(ca, code);
@@ -1359,10 +2022,10 @@ static void bound_rules_scan(ca_t *ca)
 		else if (is_code_unexplored_1(neighbour))
 			code = CD_ONE;
 		else
-			code = neighbour->code;
+			code = CA_CODE(neighbour);
 
 		code_set(ca, code);
-		id_set(ca, neighbour->id);
+		id_set(ca, CA_ID(neighbour));
 		return;
 	}
 
@@ -1374,31 +2037,42 @@ static void bound_rules_scan(ca_t *ca)
 		else if (is_code_unexplored_1(neighbour))
 			code = CD_ZERO;
 		else
-			code = neighbour->code;
+			code = CA_CODE(neighbour);
 
 		code_set(ca, code);
-		id_set(ca, neighbour->id);
+		id_set(ca, CA_ID(neighbour));
 		return;
 	}
 
-	if (!ca->mon.is_active && (ca->code == CD_ZERO || ca->code == CD_ONE) &&
-		pointing_neighbour(ca)->code == CD_FLOW) {
-		loop_success_set(ca->loop);
+	if (!mon_is_active(ca) &&
+		(CA_CODE(ca) == CD_ZERO || CA_CODE(ca) == CD_ONE) &&
+		CA_CODE(pointing_neighbour(ca)) == CD_FLOW) {
+		ca_call(loop_success_set, CA_LOOP(ca));
 	}
-	code_set(ca, neighbour->code);
-	id_set(ca, neighbour->id);
+	code_set(ca, CA_CODE(neighbour));
+	id_set(ca, CA_ID(neighbour));
+}
+
+/* the cell has the given code and direction and carries no signal other than
+ * an active monitor. flags are one-hot, so this is a single mask-and-compare
+ * of the state word */
+static int is_state_quiet(ca_t *ca, ca_code_t code, ca_direction_t dir)
+{
+	unsigned int st = CA_STATE(ca);
+
+	return (st & (ST_CODE_MASK | ST_DIR_MASK)) ==
+		(ST(CODE, code) | ST(DIR, dir)) &&
+		st & ST(FLAG, FL_QUIESCENT | FL_MONITOR_ACTIVE);
 }
 
 static ca_direction_t is_neighbour_grow(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->neighbours[cadir2dir(X)]->code == CD_GROW &&
-		ca->neighbours[cadir2dir(X)]->dir == dir_opposite(X) &&
-		cadir2dir(ca->neighbours[wind_dir_offset(cadir2dir(X),
-		1)]->dir) != wind_dir_offset(cadir2dir(X), 2) &&
-		(ca->neighbours[cadir2dir(X)]->flag == FL_QUIESCENT ||
-		ca->neighbours[cadir2dir(X)]->flag == FL_MONITOR_ACTIVE));
+	ROTATE(dir, ca, is_state_quiet(ca_neighbour(ca, cadir2dir(X)),
+		CD_GROW, dir_opposite(X)) &&
+		cadir2dir(CA_DIR(ca_neighbour(ca, wind_dir_offset(cadir2dir(X),
+		1)))) != wind_dir_offset(cadir2dir(X), 2));
 
 	return dir_opposite(dir);
 }
@@ -1410,22 +2084,19 @@ static int is_dir_well_defined(ca_direction_t dir)
 
 static int is_collision(ca_t *ca, ca_direction_t dir)
 {
-	return is_bound(ca->neighbours[cadir2dir(dir)]) &&
-		ca->neighbours[cadir2dir(dir)]->col !=
-		ca->neighbours[cadir2dir(dir_opposite(dir))]->col;
+	return is_bound(ca_neighbour(ca, cadir2dir(dir))) &&
+		CA_COL(ca_neighbour(ca, cadir2dir(dir))) !=
+		CA_COL(ca_neighbour(ca, cadir2dir(dir_opposite(dir))));
 }
 
 static int is_arm_extend(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca,
-		ca->neighbours[cadir2dir(X)]->code == CD_ARM_EXT_START &&
-		ca->neighbours[cadir2dir(X)]->dir == dir_opposite(X) &&
-		ca->neighbours[cadir2dir(dir_opposite(X))]->dir ==
-		DR_QUIESCENT &&
-		(ca->neighbours[cadir2dir(X)]->flag == FL_QUIESCENT ||
-		ca->neighbours[cadir2dir(X)]->flag == FL_MONITOR_ACTIVE));
+	ROTATE(dir, ca, is_state_quiet(ca_neighbour(ca, cadir2dir(X)),
+		CD_ARM_EXT_START, dir_opposite(X)) &&
+		CA_DIR(ca_neighbour(ca, cadir2dir(dir_opposite(X)))) ==
+		DR_QUIESCENT);
 
 	return dir_opposite(dir);
 }
@@ -1434,13 +2105,10 @@ static int is_turn_left(ca_t *ca)
 {
 	ca_direction_t dir;
 
-	ROTATE(dir, ca, ca->neighbours[cadir2dir(X)]->code == CD_TURN_LEFT &&
-		cadir2dir(ca->neighbours[cadir2dir(X)]->dir) ==
-		wind_dir_offset(cadir2dir(X), -2) &&
-		ca->neighbours[wind_dir_offset(cadir2dir(X), -1)]->dir ==
-		DR_QUIESCENT &&
-		(ca->neighbours[cadir2dir(X)]->flag == FL_QUIESCENT ||
-		ca->neighbours[cadir2dir(X)]->flag == FL_MONITOR_ACTIVE));
+	ROTATE(dir, ca, is_state_quiet(ca_neighbour(ca, cadir2dir(X)),
+		CD_TURN_LEFT, dir2cadir(wind_dir_offset(cadir2dir(X), -2))) &&
+		CA_DIR(ca_neighbour(ca, wind_dir_offset(cadir2dir(X), -1))) ==
+		DR_QUIESCENT);
 
 	return dir_opposite(dir);
 }
@@ -1465,8 +2133,8 @@ static void unbound_rules_scan(ca_t *ca)
 		}
 		else {
 			code_set(ca, CD_FLOW);
-			col_set(ca, ca->neighbours[
-				cadir2dir(dir_opposite(dir))]->col);
+			col_set(ca, CA_COL(ca_neighbour(ca,
+				cadir2dir(dir_opposite(dir)))));
 		}
 		return;
 	}
@@ -1488,8 +2156,8 @@ static void unbound_rules_scan(ca_t *ca)
 			flag_set(ca, FL_COLLISION);
 		}
 		else {
-			col_set(ca, ca->neighbours[
-				cadir2dir(dir_opposite(dir))]->col);
+			col_set(ca, CA_COL(ca_neighbour(ca,
+				cadir2dir(dir_opposite(dir)))));
 		}
 		return;
 	}
@@ -1498,6 +2166,13 @@ static void unbound_rules_scan(ca_t *ca)
 static void ca_scan(void *o)
 {
 	ca_t *ca = (ca_t *)o;
+	ca_space_t *s = CA_SPACE(ca);
+
+	/* the synchronous engine sweeps between generations, the event driven
+	 * one from an event of its own so that no block is let go of while one
+	 * of its cells is being scanned */
+	if (!s->cb->is_sync && !(++s->scan_count % BLOCK_SWEEP_SCANS))
+		event_add_once(blocks_sweep_event, s);
 
 	flags_scan(ca);
 	if (is_bound(ca))
@@ -1506,45 +2181,151 @@ static void ca_scan(void *o)
 		unbound_rules_scan(ca);
 }
 
-static ca_t *loop_assignment_get_next(void)
+static void ca_step(void *o);
+
+/* the tiles are consecutive runs of the scan bitmap's words, split so that
+ * each has about as many cells due as the others */
+static void ca_tiles_split(ca_space_t *s)
 {
-	ca_t **ca;
+	ca_tiles_t *tiles = s->tiles;
+	int i, t = 0, sum = 0;
 
-	for (ca = loop_queue_success->ca_list; (*ca)->code != CD_TURN_LEFT;
-		ca++);
-	return pointing_neighbour(*ca);
+	tiles->tile[0].word_start = 0;
+	for (i = 0; i < s->scan_map_words && t < tiles->num - 1; i++) {
+		sum += __builtin_popcountl(s->scan_map[i]);
+		if ((long long)sum * tiles->num >=
+			(long long)(t + 1) * s->scan_num) {
+			tiles->tile[t].word_end = i + 1;
+			tiles->tile[++t].word_start = i + 1;
+		}
+	}
+	for (; t < tiles->num - 1; t++) {
+		tiles->tile[t].word_end = i;
+		tiles->tile[t + 1].word_start = i;
+	}
+	tiles->tile[t].word_end = s->scan_map_words;
+}
+
+/* what the tiles' scans left undone is done tile by tile, in the order in
+ * which a single thread scanning the cells in memory order would have */
+static void ca_tiles_merge(ca_space_t *s)
+{
+	ca_tiles_t *tiles = s->tiles;
+	int i, j;
+
+	for (i = 0; i < tiles->num; i++) {
+		ca_tile_t *tile = &tiles->tile[i];
+
+		for (j = 0; j < tile->ops_num; j++) {
+			tile_op_t *op = &tile->ops[j];
+
+			switch (op->type) {
+			case TILE_OP_SCAN:
+				ca_scan_set((ca_t *)op->data);
+				break;
+			case TILE_OP_DIRTY:
+				ca_dirty_set((ca_t *)op->data);
+				break;
+			case TILE_OP_EVENT:
+				event_add(op->func, op->data);
+				break;
+			case TILE_OP_CALL:
+				op->func(op->data);
+				break;
+			}
+		}
+		tile->ops_num = 0;
+
+		if (tile->is_error) {
+			tile->is_error = 0;
+			error_set();
+		}
+	}
+}
+
+/* a generation scanned by all tiles at once */
+static void ca_tiles_scan(ca_space_t *s)
+{
+	ca_tiles_t *tiles = s->tiles;
+
+	ca_tiles_split(s);
+	pthread_barrier_wait(&tiles->barrier);
+	tile_scan(&tiles->tile[0]);
+	pthread_barrier_wait(&tiles->barrier);
+	ca_tiles_merge(s);
 }
 
-static int assignments_set(void)
+/* ends a synchronous generation by swapping the read and write buffers. the
+ * cells written are then copied back so both buffers agree again */
+static void ca_commit(void *o)
 {
+	ca_space_t *s = (ca_space_t *)o;
+	unsigned long *scan_map = s->scan_map;
 	int i;
-	sat_loop_t *queue;
 
-	if (!loop_queue_success)
-		return 0;
+	s->rd = s->wr;
+	s->wr = !s->rd;
+	for (i = 0; i < s->dirty_num; i++) {
+		int idx = s->dirty[i], off = BLOCK_OFF(idx);
+		ca_block_t *blk = s->blocks[BLOCK_IDX(idx)];
 
-	for (queue = loop_queue_success, i = 0; queue; queue = queue->next,
-		i++);
-	if (table_assignment_init(table, i))
-		return -1;
+		blk->states[s->wr][off] = blk->states[s->rd][off];
+		blk->ids[s->wr][off] = blk->ids[s->rd][off];
+		blk->is_dirty[off] = 0;
+	}
+	s->dirty_num = 0;
 
-	i = 0;
-	while (loop_queue_success) {
-		int id;
-		ca_t *ca = loop_assignment_get_next();
+	s->scan_map = s->scan_map_next;
+	s->scan_num = s->scan_next_num;
+	s->scan_map_next = scan_map;
+	s->scan_next_num = 0;
+	memset(s->scan_map_next, 0, s->scan_map_words * sizeof(unsigned long));
 
-		for (id = 1; id <= table->var_num; id++) {
-			table_assignment_insert(table, i, id,
-				code2code(truth_values, ca->code));
-			ca = pointing_neighbour(ca);
-		}
+	if (!(s->generation_num % BLOCK_SWEEP_GENERATIONS))
+		blocks_sweep(s);
+
+	if (s->scan_num)
+		event_add(ca_step, s);
+}
+
+/* a synchronous generation: every cell due is scanned against the read
+ * buffer, its new fields going to the write buffer. the buffers are swapped
+ * in the next generation, alongside the loop and monitor events the scans
+ * gave rise to, just as the fields' own events would have been called */
+static void ca_step(void *o)
+{
+	ca_space_t *s = (ca_space_t *)o;
+
+	s->generation_num++;
+	s->active_sum += s->scan_num;
+	if (s->active_max < s->scan_num)
+		s->active_max = s->scan_num;
+
+	event_add(ca_commit, s);
+
+	/* the cells due are scanned in memory order */
+	if (s->tiles && s->scan_num >= s->tiles->cells_min * s->tiles->num)
+		ca_tiles_scan(s);
+	else
+		ca_scan_words(s, 0, s->scan_map_words);
+}
+
+/* records what the last loops to succeed did not get to before the run was
+ * over, and lets go of the successful loops */
+static int assignments_set(ca_space_t *s)
+{
+	int ret = 0;
 
-		i++;
-		queue = loop_queue_success;
-		loop_queue_success = loop_queue_success->next;
+	while (s->loop_queue_success) {
+		sat_loop_t *queue = s->loop_queue_success;
+
+		if (!s->cb->is_count)
+			ret |= loop_assignment_record(queue);
+		event_del_all(queue);
+		s->loop_queue_success = s->loop_queue_success->next;
 		loop_del(queue);
 	}
-	return 0;
+	return ret;
 }
 
 static void sat_epilogue(void *o)
@@ -1552,18 +2333,54 @@ static void sat_epilogue(void *o)
 	ca_space_t *s = (ca_space_t *)o;
 
 	if (s->print_field != SAT_PRINT_FIELD_NONE)
-		sat_print_uninit();
+		sat_print_uninit(s);
+
+	if (s->cb->is_stats) {
+		if (s->generation_num) {
+			fprintf(stderr, "generations: %d, active cells per "
+				"generation: %lld average, %d at most\n",
+				s->generation_num,
+				s->active_sum / s->generation_num,
+				s->active_max);
+		}
+		fprintf(stderr, "blocks: %d at most, of %d\n", s->block_max,
+			s->block_dir_sz);
+	}
 
-	event_add(assignments_set() ? sat_error_handler : sat_success_handler,
+	event_add(assignments_set(s) ? sat_error_handler : sat_success_handler,
 		o);
 }
 
+static void loops_active_del(ca_space_t *s)
+{
+	while (s->loop_queue_active) {
+		sat_loop_t *loop = s->loop_queue_active;
+
+		s->loop_queue_active = loop->next;
+		event_del_all(loop);
+		loop_del(loop);
+	}
+}
+
+/* the run is over once no loop is left active, or as soon as enough loops
+ * have succeeded, in which case the loops still active are let go of */
 static void sig_loop_cb(sig_t sig, void *o)
 {
-	if (loop_queue_active)
+	ca_space_t *s = (ca_space_t *)o;
+
+	if (s->is_over || (s->loop_queue_active && !is_assignment_max(s)))
 		return;
+
+	s->is_over = 1;
 	sat_event_loop_clear(o);
-	event_add(sat_epilogue, o);
+	loops_active_del(s);
+
+	/* a run being displayed, however short, is shown for a frame's pause
+	 * before its final state is drawn */
+	if (s->print_field != SAT_PRINT_FIELD_NONE)
+		event_add_timer(sat_epilogue, o, s->print_pause_microsec);
+	else
+		event_add(sat_epilogue, o);
 }
 
 static void sig_error_cb(sig_t s, void *o)
@@ -1575,7 +2392,8 @@ static void sig_error_cb(sig_t s, void *o)
 static void sp_initial_configuration(void *o)
 {
 	ca_space_t *s = (ca_space_t *)o;
-	int i = 0, vars = table->var_num, id = 1, x_offset, y_offset;
+	int i = 0, vars = s->table->var_num, id = 1, x_offset, y_offset;
+	ca_t *ca;
 
 	/* initial loop's bottom left coordinates */
 	s->x0 = ((s->sp_dim / (2 * (s->loop_dim + 1))) - 1) * (s->loop_dim + 1);
@@ -1583,111 +2401,121 @@ static void sp_initial_configuration(void *o)
 
 	/* set turn left code in bottom left corner and initiate monitor
 	 * spreading */
-	s->sp[s->y0][s->x0].code = CD_TURN_LEFT;
-	s->sp[s->y0][s->x0].dir = DR_DOWN;
-	s->sp[s->y0][s->x0].col = CL_RED;
-	event_add_once(ca_scan, &s->sp[s->y0][s->x0]);
-	event_add_once(mon_spread_scan, &s->sp[s->y0][s->x0]);
-	loop_new_set(&s->sp[s->y0][s->x0]);
+	ca = sp_cell(s, s->y0, s->x0);
+	CA_SET(ca, CODE, CD_TURN_LEFT);
+	CA_SET(ca, DIR, DR_DOWN);
+	CA_SET(ca, COL, CL_RED);
+	ca_scan_set(ca);
+	event_add_once(mon_spread_scan, ca);
+	loop_new_set(ca);
 
 	/* set grow and loop extension flow codes on the bottom */
 	for (i = 1; i < s->loop_dim + 2; i++) {
 		x_offset = s->x0 + i;
+		ca = sp_cell(s, s->y0, x_offset);
 
-		s->sp[s->y0][x_offset].code = i < s->loop_dim ?
-			CD_GROW : CD_FLOW;
-		s->sp[s->y0][x_offset].dir = DR_RIGHT;
-		s->sp[s->y0][x_offset].col = CL_RED;
-		event_add_once(ca_scan, &s->sp[s->y0][x_offset]);
+		CA_SET(ca, CODE, i < s->loop_dim ? CD_GROW : CD_FLOW);
+		CA_SET(ca, DIR, DR_RIGHT);
+		CA_SET(ca, COL, CL_RED);
+		ca_scan_set(ca);
 	}
-	event_add_once(mon_spread_scan, &s->sp[s->y0][s->x0 + s->loop_dim + 1]);
+	event_add_once(mon_spread_scan,
+		sp_cell(s, s->y0, s->x0 + s->loop_dim + 1));
 
 	/* set loop unexplored and flow codes to the left */
 	for (i = 1; i < s->loop_dim; i++) {
 		y_offset = s->y0 - i;
+		ca = sp_cell(s, y_offset, s->x0);
 
 		if (vars) {
-			s->sp[y_offset][s->x0].code = CD_UNEXPLORED_0;
-			s->sp[y_offset][s->x0].id = id;
-			s->sp[y_offset][s->x0].col = CL_RED;
+			CA_SET(ca, CODE, CD_UNEXPLORED_0);
+			ca_id_set(ca, id);
+			CA_SET(ca, COL, CL_RED);
 			id++;
 			vars--;
 		}
 		else {
-			s->sp[y_offset][s->x0].code = CD_FLOW;
+			CA_SET(ca, CODE, CD_FLOW);
 		}
-		s->sp[y_offset][s->x0].dir = y_offset ==
-			s->y0 - s->loop_dim + 1 ? DR_LEFT : DR_DOWN;
-		s->sp[y_offset][s->x0].col = CL_RED;
-		event_add_once(ca_scan, &s->sp[y_offset][s->x0]);
+		CA_SET(ca, DIR, y_offset == s->y0 - s->loop_dim + 1 ? DR_LEFT :
+			DR_DOWN);
+		CA_SET(ca, COL, CL_RED);
+		ca_scan_set(ca);
 	}
 
 	/* set loop unexplored and flow codes on the top */
 	y_offset = s->y0 - s->loop_dim + 1;
 	for (i = 1; i < s->loop_dim; i++) {
 		x_offset = s->x0 + i;
+		ca = sp_cell(s, y_offset, x_offset);
 
 		if (vars) {
-			s->sp[y_offset][x_offset].code = CD_UNEXPLORED_0;
-			s->sp[y_offset][x_offset].id = id;
+			CA_SET(ca, CODE, CD_UNEXPLORED_0);
+			ca_id_set(ca, id);
 			id++;
 			vars--;
 		}
 		else {
-			s->sp[y_offset][x_offset].code = CD_FLOW;
+			CA_SET(ca, CODE, CD_FLOW);
 		}
-		s->sp[y_offset][x_offset].dir = i == s->loop_dim - 1 ?
-			DR_UP : DR_LEFT;
-		s->sp[y_offset][x_offset].col = CL_RED;
-		event_add_once(ca_scan, &s->sp[y_offset][x_offset]);
+		CA_SET(ca, DIR, i == s->loop_dim - 1 ? DR_UP : DR_LEFT);
+		CA_SET(ca, COL, CL_RED);
+		ca_scan_set(ca);
 	}
 
 	/* set loop unexplored and flow codes to the right */
 	x_offset = s->x0 + s->loop_dim - 1;
 	for (i = 0; i < s->loop_dim - 2; i++) {
 		y_offset = s->y0 - s->loop_dim + 2 + i;
+		ca = sp_cell(s, y_offset, x_offset);
 		if (vars) {
-			s->sp[y_offset][x_offset].code = CD_UNEXPLORED_0;
-			s->sp[y_offset][x_offset].id = id;
+			CA_SET(ca, CODE, CD_UNEXPLORED_0);
+			ca_id_set(ca, id);
 			id++;
 			vars--;
 		}
 		else {
-			s->sp[y_offset][x_offset].code = CD_FLOW;
+			CA_SET(ca, CODE, CD_FLOW);
 		}
-		s->sp[y_offset][x_offset].dir = DR_UP;
-		s->sp[y_offset][x_offset].col = CL_RED;
-		event_add_once(ca_scan, &s->sp[y_offset][x_offset]);
+		CA_SET(ca, DIR, DR_UP);
+		CA_SET(ca, COL, CL_RED);
+		ca_scan_set(ca);
 
 		if (vars)
 			vars--;
 	}
+
+	/* the initial configuration is in place before the first generation */
+	if (s->cb->is_sync)
+		ca_commit(s);
 }
 
 static void sat_print_monitor_params_get(ca_space_t *s, int i, int j,
 	sat_print_t *printer)
 {
-	monitor_t mon = s->sp[i][j].mon;
-	int is_pulse = loop_queue_active && (s->sp[i][j].code == CD_TURN_LEFT);
+	ca_t *ca = sp_cell_read(s, i, j);
+	monitor_t *mon = CA_MON(ca);
+	int is_pulse = s->loop_queue_active && (CA_CODE(ca) == CD_TURN_LEFT);
 
-	if (mon.is_active) {
+	if (mon && mon->is_active) {
 		int i, cur = 0, pos = 0;
 
-		for (i = 0; i < mon.pos_tbl_sz; i++) {
-			if (mon.pos_tbl[i] <= pos)
+		for (i = 0; i < mon->pos_tbl_sz; i++) {
+			if (mon->pos_tbl[i] <= pos)
 				continue;
-			pos = mon.pos_tbl[i];
+			pos = mon->pos_tbl[i];
 			cur = i;
 		}
 
 		printer->representation = ASCII_ONE + pos;
-		printer->colour = is_mon_fail(&mon, cur) ? COL_RED : COL_GREEN;
+		printer->colour = is_mon_fail(s->table, mon, cur) ? COL_RED :
+			COL_GREEN;
 		printer->is_bright = is_pulse ? ATTR_BRIGHT : ATTR_DULL;
 	}
 	else {
 		int idx;
 
-		if (!is_bound(&s->sp[i][j])) {
+		if (!is_bound(ca)) {
 			idx = CD_QUIESCENT;
 			is_pulse = 0;
 		}
@@ -1705,6 +2533,7 @@ static void sat_print_monitor_params_get(ca_space_t *s, int i, int j,
 void sat_print_params_get(void *o, int i, int j, sat_print_t *printer)
 {
 	ca_space_t *s = (ca_space_t *)o;
+	ca_t *ca = sp_cell_read(s, i, j);
 	sat_print_t *table;
 	int idx, is_pulse = 0;
 
@@ -1712,20 +2541,20 @@ void sat_print_params_get(void *o, int i, int j, sat_print_t *printer)
 	{
 	case SAT_PRINT_FIELD_CODE:
 		table = sat_print_code;
-		idx = s->sp[i][j].code;
+		idx = CA_CODE(ca);
 		break;
 	case SAT_PRINT_FIELD_DIR:
 		table = sat_print_dir;
-		idx = s->sp[i][j].dir;
-		if (s->sp[i][j].code == CD_TURN_LEFT)
+		idx = CA_DIR(ca);
+		if (CA_CODE(ca) == CD_TURN_LEFT)
 			is_pulse = 1;
 		break;
 	case SAT_PRINT_FIELD_FLAG:
 		table = sat_print_flag;
-		if (s->sp[i][j].flag == FL_QUIESCENT) {
-			if (is_bound(&s->sp[i][j])) {
+		if (CA_FLAG(ca) == FL_QUIESCENT) {
+			if (is_bound(ca)) {
 				idx = IDX_QUIESCENT_BOUND;
-				if (s->sp[i][j].code == CD_TURN_LEFT)
+				if (CA_CODE(ca) == CD_TURN_LEFT)
 					is_pulse = 1;
 			}
 			else {
@@ -1733,13 +2562,13 @@ void sat_print_params_get(void *o, int i, int j, sat_print_t *printer)
 			}
 		}
 		else {
-			idx = code2code(flag2idx, s->sp[i][j].flag);
+			idx = code2code(flag2idx, CA_FLAG(ca));
 		}
 		break;
 	case SAT_PRINT_FIELD_COLOUR:
 		table = sat_print_colour;
-		idx = s->sp[i][j].col;
-		if (s->sp[i][j].code == CD_TURN_LEFT)
+		idx = CA_COL(ca);
+		if (CA_CODE(ca) == CD_TURN_LEFT)
 			is_pulse = 1;
 		break;
 	case SAT_PRINT_FIELD_MONITOR:
@@ -1749,34 +2578,100 @@ void sat_print_params_get(void *o, int i, int j, sat_print_t *printer)
 		return;
 	}
 
-	if (!loop_queue_active)
+	if (!s->loop_queue_active)
 		is_pulse = 0;
 	printer->representation = table[idx].representation;
 	printer->colour = table[idx].colour;
 	printer->is_bright = (table[idx].is_bright + is_pulse) % 2;
 }
 
-void sp_init(ca_space_cb_t *cb, table_t *tbl, sat_print_field_t print_field,
-	sat_print_speed_t print_speed)
-{
-	ca_space.cb = cb;
-	ca_space.sp_dim = sp_dim_get(tbl->var_num);
-	ca_space.loop_dim = (tbl->var_num + 8) / 3;
-	ca_space.print_field = print_field;
-	if (!(ca_space.sp = ca_space_alloc(ca_space.sp_dim, ca_space.sp_dim))) {
-		event_add(sat_error_handler, &ca_space);
+/* event callbacks named in the profiling report */
+EVENT_PROFILE_START(ca_profile_syms)
+	EVENT_PROFILE_ENTRY(signal_loop)
+	EVENT_PROFILE_ENTRY(loop_new)
+	EVENT_PROFILE_ENTRY(loop_fail)
+	EVENT_PROFILE_ENTRY(loop_fail_set)
+	EVENT_PROFILE_ENTRY(loop_fail_reset)
+	EVENT_PROFILE_ENTRY(loop_success)
+	EVENT_PROFILE_ENTRY(loop_record)
+	EVENT_PROFILE_ENTRY(mon_uninit)
+	EVENT_PROFILE_ENTRY(mon_deactivate)
+	EVENT_PROFILE_ENTRY(sat_event_loop_clear)
+	EVENT_PROFILE_ENTRY(blocks_sweep_event)
+	EVENT_PROFILE_ENTRY(sat_error_handler)
+	EVENT_PROFILE_ENTRY(sat_success_handler)
+	EVENT_PROFILE_ENTRY(mon_spread_do)
+	EVENT_PROFILE_ENTRY(mon_spread_scan)
+	EVENT_PROFILE_ENTRY(mon_spread_init_phase2)
+	EVENT_PROFILE_ENTRY(mon_spread_init_phase2_set)
+	EVENT_PROFILE_ENTRY(mon_spread_init_phase1)
+	EVENT_PROFILE_ENTRY(flag_set_queiscent)
+	EVENT_PROFILE_ENTRY(flag_set_erase_loop)
+	EVENT_PROFILE_ENTRY(flag_set_collision)
+	EVENT_PROFILE_ENTRY(flag_set_branch_seq)
+	EVENT_PROFILE_ENTRY(flag_set_gen_zero)
+	EVENT_PROFILE_ENTRY(flag_set_gen_one)
+	EVENT_PROFILE_ENTRY(flag_set_monitor_active)
+	EVENT_PROFILE_ENTRY(flag_set_monitor_allert)
+	EVENT_PROFILE_ENTRY(code_set_quiescent)
+	EVENT_PROFILE_ENTRY(code_set_flow)
+	EVENT_PROFILE_ENTRY(code_set_grow)
+	EVENT_PROFILE_ENTRY(code_set_turn_left)
+	EVENT_PROFILE_ENTRY(code_set_arm_ext_start)
+	EVENT_PROFILE_ENTRY(code_set_arm_ext_end)
+	EVENT_PROFILE_ENTRY(code_set_detach)
+	EVENT_PROFILE_ENTRY(code_set_unexplored_0)
+	EVENT_PROFILE_ENTRY(code_set_unexplored_1)
+	EVENT_PROFILE_ENTRY(code_set_zero)
+	EVENT_PROFILE_ENTRY(code_set_one)
+	EVENT_PROFILE_ENTRY(code_set_tautology)
+	EVENT_PROFILE_ENTRY(code_set_paradox)
+	EVENT_PROFILE_ENTRY(dir_set_quiescent)
+	EVENT_PROFILE_ENTRY(dir_set_up)
+	EVENT_PROFILE_ENTRY(dir_set_down)
+	EVENT_PROFILE_ENTRY(dir_set_left)
+	EVENT_PROFILE_ENTRY(dir_set_right)
+	EVENT_PROFILE_ENTRY(col_set_quiescent)
+	EVENT_PROFILE_ENTRY(col_set_white)
+	EVENT_PROFILE_ENTRY(col_set_yellow)
+	EVENT_PROFILE_ENTRY(col_set_blue)
+	EVENT_PROFILE_ENTRY(col_set_red)
+	EVENT_PROFILE_ENTRY(id_reset)
+	EVENT_PROFILE_ENTRY(id_inc)
+	EVENT_PROFILE_ENTRY(set_scan)
+	EVENT_PROFILE_ENTRY(ca_scan)
+	EVENT_PROFILE_ENTRY(ca_step)
+	EVENT_PROFILE_ENTRY(ca_commit)
+	EVENT_PROFILE_ENTRY(sat_epilogue)
+	EVENT_PROFILE_ENTRY(sp_initial_configuration)
+EVENT_PROFILE_END
+
+void sp_init(ca_space_t *s, ca_space_cb_t *cb, table_t *tbl,
+	sat_print_field_t print_field, sat_print_speed_t print_speed)
+{
+	s->cb = cb;
+	s->sp_dim = sp_dim_get(tbl->var_num);
+	s->loop_dim = (tbl->var_num + 8) / 3;
+	s->print_field = print_field;
+	s->loop_queue_active = NULL;
+	s->loop_queue_success = NULL;
+	s->success_num = 0;
+	s->is_over = 0;
+	EVENT_PROFILE_REGISTER(ca_profile_syms);
+	/* cell ids are kept in shorts */
+	if (tbl->var_num > USHRT_MAX || ca_space_alloc(s)) {
+		event_add(sat_error_handler, s);
 		return;
 	}
 
-	table = tbl;
-	loop_len = 4 * (ca_space.loop_dim - 1);
-	clause_num = table->record_dim - 1;
+	s->table = tbl;
+	s->loop_len = 4 * (s->loop_dim - 1);
+	s->clause_num = s->table->record_dim - 1;
 
-	signal_register(SIG_LOOP, sig_loop_cb, &ca_space);
-	signal_register(SIG_ERROR, sig_error_cb, &ca_space);
+	signal_register(SIG_LOOP, sig_loop_cb, s);
+	signal_register(SIG_ERROR, sig_error_cb, s);
 
-	event_add(sp_initial_configuration, &ca_space);
-	if (ca_space.print_field != SAT_PRINT_FIELD_NONE)
-		sat_print_init(&ca_space, ca_space.sp_dim, print_speed);
+	event_add(sp_initial_configuration, s);
+	if (s->print_field != SAT_PRINT_FIELD_NONE)
+		sat_print_init(s, print_speed);
 }
-
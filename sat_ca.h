@@ -31,10 +31,71 @@ typedef struct ca_space_cb_t {
 	void *success_data;
 	event_func_t fail_cb;
 	void *fail_data;
+	void (*assignment_cb)(void *data, table_t *table, int idx);
+	void *assignment_data;
+	int assignment_max;
+	int is_count;
+	int is_sync;
+	int sync_threads;
+	int tile_cells_min;
+	int is_stats;
 } ca_space_cb_t;
 
-void sp_init(ca_space_cb_t *cb, table_t *tbl, sat_print_field_t print_field,
-	sat_print_speed_t print_speed);
+/* a cellular automata space solving a single table. cells, monitors and
+ * loops refer back to their space so several spaces can be run at once.
+ * the cells' handles and fields are kept in blocks of 64 x 64 cells, a
+ * cell's index being that of its block followed by its row and column in the
+ * block. blocks are allocated once looked up and let go of once quiescent
+ * again, the blocks not allocated being NULL and read from block_quiet when
+ * printed. a block which could not be allocated is stood in for by
+ * block_spare. a cell's code, direction, colour and flag share a single
+ * state word. monitors are allocated only for the cells which have one. a
+ * space stepped synchronously reads its blocks' rd buffers while writing
+ * their wr buffers, otherwise the two are one and the same. its cells due for
+ * a scan are then kept as bits over the cells' indices, and may be split into
+ * tiles scanned by threads of their own */
+typedef struct ca_space_t {
+	ca_space_cb_t *cb;
+	struct ca_block_t **blocks;
+	struct ca_block_t *block_quiet;
+	struct ca_block_t *block_spare;
+	int block_dim;
+	int block_dir_sz;
+	int block_num;
+	int block_max;
+	int rd;
+	int wr;
+	int nei_offsets[8];
+	unsigned long *scan_map;
+	unsigned long *scan_map_next;
+	int scan_map_words;
+	int scan_num;
+	int scan_next_num;
+	int *dirty;
+	int dirty_num;
+	int dirty_sz;
+	long long scan_count;
+	struct ca_tiles_t *tiles;
+	int sp_dim;
+	int loop_dim;
+	sat_print_field_t print_field;
+	int print_pause_microsec;
+	int x0;
+	int y0;
+	table_t *table;
+	int loop_len;
+	int clause_num;
+	struct sat_loop_t *loop_queue_active;
+	struct sat_loop_t *loop_queue_success;
+	int success_num;
+	int is_over;
+	int generation_num;
+	long long active_sum;
+	int active_max;
+} ca_space_t;
+
+void sp_init(ca_space_t *s, ca_space_cb_t *cb, table_t *tbl,
+	sat_print_field_t print_field, sat_print_speed_t print_speed);
 void sat_print_params_get(void *o, int i, int j, sat_print_t *printer);
 
 #endif
@@ -0,0 +1,223 @@
+#include "sat_component.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+static int uf_find(int *parent, int id)
+{
+	while (parent[id] != id) {
+		parent[id] = parent[parent[id]];
+		id = parent[id];
+	}
+
+	return id;
+}
+
+static void uf_union(int *parent, int *size, int id1, int id2)
+{
+	int tmp;
+
+	if ((id1 = uf_find(parent, id1)) == (id2 = uf_find(parent, id2)))
+		return;
+
+	if (size[id1] < size[id2]) {
+		tmp = id1;
+		id1 = id2;
+		id2 = tmp;
+	}
+
+	parent[id2] = id1;
+	size[id1] += size[id2];
+}
+
+/* larger components first, so that they are the first to be solved. ties
+ * go by the lowest variable id so that the order does not depend on qsort */
+static int component_cmp(const void *c1, const void *c2)
+{
+	component_t *comp1 = (component_t *)c1, *comp2 = (component_t *)c2;
+
+	if (comp1->var_num != comp2->var_num)
+		return comp2->var_num - comp1->var_num;
+
+	return comp1->map[1] - comp2->map[1];
+}
+
+static int component_clause_add(component_t *comp, int *local,
+	literal_t *lit, int dim)
+{
+	int i;
+
+	if (clause_new(&comp->clauses))
+		return -1;
+
+	for (i = 0; i < dim; i++) {
+		int id = local[lit[i].id];
+
+		if (clause_add_id(comp->clauses, id, lit[i].tv != SAT_TV_FALSE))
+			return -1;
+
+		/* a tautology is had by adding its other half */
+		if (lit[i].tv == SAT_TV_TAUTOLOGY &&
+			clause_add_id(comp->clauses, id, 0)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* splits the expression into its connected components: two variables are
+ * connected if they share a clause. unless is_split is set the whole
+ * expression is taken as a single component. every variable is expected to
+ * appear in some clause, as is the case after preprocessing */
+int components_split(components_t *c, clauses_t *clauses, int var_num,
+	int is_split)
+{
+	int *parent = NULL, *size = NULL, *local = NULL, i, j, ret = -1;
+
+	memset(c, 0, sizeof(components_t));
+	if (!clauses || !clauses->num)
+		return 0;
+
+	for (i = 0; i < clauses->literal_num; i++) {
+		if (clauses->literals[i].id > var_num)
+			var_num = clauses->literals[i].id;
+	}
+
+	if (!(parent = calloc(var_num + 1, sizeof(int))) ||
+		!(size = calloc(var_num + 1, sizeof(int))) ||
+		!(local = calloc(var_num + 1, sizeof(int)))) {
+		goto Exit;
+	}
+
+	for (i = 0; i <= var_num; i++) {
+		parent[i] = i;
+		size[i] = 1;
+	}
+
+	for (i = 0; i < clauses->num; i++) {
+		literal_t *lit = clauses->literals + clauses->offsets[i];
+
+		if (!clauses->dims[i])
+			goto Exit;
+
+		for (j = 0; j < clauses->dims[i]; j++) {
+			uf_union(parent, size, is_split ? lit->id : 0,
+				lit[j].id);
+		}
+	}
+
+	/* size[] now holds, per root, its component's index plus one */
+	memset(size, 0, (var_num + 1) * sizeof(int));
+	for (i = 0; i < clauses->literal_num; i++) {
+		int root = uf_find(parent, clauses->literals[i].id);
+
+		if (!size[root])
+			size[root] = ++c->num;
+	}
+
+	if (!(c->comps = calloc(c->num, sizeof(component_t))))
+		goto Exit;
+
+	for (i = 1; i <= var_num; i++) {
+		int root = uf_find(parent, i);
+
+		if (size[root])
+			local[i] = ++c->comps[size[root] - 1].var_num;
+	}
+
+	for (i = 0; i < c->num; i++) {
+		if (!(c->comps[i].map = calloc(c->comps[i].var_num + 1,
+			sizeof(int)))) {
+			goto Exit;
+		}
+	}
+
+	for (i = 1; i <= var_num; i++) {
+		int root = uf_find(parent, i);
+
+		if (size[root])
+			c->comps[size[root] - 1].map[local[i]] = i;
+	}
+
+	for (i = 0; i < clauses->num; i++) {
+		literal_t *lit = clauses->literals + clauses->offsets[i];
+		int root = uf_find(parent, lit->id);
+
+		if (component_clause_add(&c->comps[size[root] - 1], local, lit,
+			clauses->dims[i])) {
+			goto Exit;
+		}
+	}
+
+	qsort(c->comps, c->num, sizeof(component_t), component_cmp);
+	ret = 0;
+
+Exit:
+	free(parent);
+	free(size);
+	free(local);
+	if (ret)
+		components_clr(c);
+	return ret;
+}
+
+/* the size of the cross product of the components' assignments, or -1 if
+ * it is too large to count */
+long long components_assignment_num(components_t *c)
+{
+	long long num = 1;
+	int i;
+
+	for (i = 0; i < c->num; i++) {
+		int n = c->comps[i].table->assignment_num;
+
+		if (!n)
+			return 0;
+		if (num > LLONG_MAX / n)
+			return -1;
+		num *= n;
+	}
+
+	return num;
+}
+
+/* the component's assignment idx, written to values[] which is indexed by
+ * the expression's variable ids */
+void component_assignment_get(component_t *comp, int idx, sat_tv_t *values)
+{
+	int j;
+
+	for (j = 1; j <= comp->var_num; j++)
+		values[comp->map[j]] = table_assignment_get(comp->table, idx, j);
+}
+
+/* assignment idx of the cross product, computed on demand rather than kept.
+ * the first component is the most significant */
+void components_assignment_get(components_t *c, long long idx,
+	sat_tv_t *values)
+{
+	int i;
+
+	for (i = c->num - 1; i >= 0; i--) {
+		int n = c->comps[i].table->assignment_num;
+
+		component_assignment_get(&c->comps[i], idx % n, values);
+		idx /= n;
+	}
+}
+
+void components_clr(components_t *c)
+{
+	int i;
+
+	for (i = 0; i < c->num && c->comps; i++) {
+		clause_clr(&c->comps[i].clauses);
+		free(c->comps[i].map);
+		table_clr(c->comps[i].table);
+	}
+
+	free(c->comps);
+	memset(c, 0, sizeof(components_t));
+}
+
@@ -0,0 +1,32 @@
+#ifndef _SAT_COMPONENT_H_
+#define _SAT_COMPONENT_H_
+
+#include "sat_table.h"
+
+/* a variable disjoint part of an expression, over variables 1..var_num of
+ * its own. map[] takes them back to the expression's variable ids. table
+ * holds the component's assignments once it has been solved, count the
+ * number of them, which is all there is when only counting */
+typedef struct component_t {
+	clauses_t *clauses;
+	int var_num;
+	int *map;
+	table_t *table;
+	int count;
+} component_t;
+
+typedef struct components_t {
+	component_t *comps;
+	int num;
+} components_t;
+
+int components_split(components_t *c, clauses_t *clauses, int var_num,
+	int is_split);
+void component_assignment_get(component_t *comp, int idx, sat_tv_t *values);
+long long components_assignment_num(components_t *c);
+void components_assignment_get(components_t *c, long long idx,
+	sat_tv_t *values);
+void components_clr(components_t *c);
+
+#endif
+
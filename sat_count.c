@@ -0,0 +1,163 @@
+#include "sat_count.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define COUNT_LIMB_BITS 32
+#define COUNT_LIMBS_MIN 4
+#define COUNT_DEC_BASE 1000000000U
+#define COUNT_DEC_DIGITS 9
+
+static int count_reserve(count_t *c, int num)
+{
+	unsigned int *limbs;
+	int sz = c->sz ? c->sz : COUNT_LIMBS_MIN;
+
+	if (num <= c->sz)
+		return 0;
+
+	while (sz < num)
+		sz *= 2;
+
+	if (!(limbs = realloc(c->limbs, sz * sizeof(unsigned int))))
+		return -1;
+
+	c->limbs = limbs;
+	c->sz = sz;
+	return 0;
+}
+
+/* drops the leading zero limbs */
+static void count_trim(count_t *c)
+{
+	while (c->num && !c->limbs[c->num - 1])
+		c->num--;
+}
+
+int count_set(count_t *c, unsigned int val)
+{
+	c->num = 0;
+	if (!val)
+		return 0;
+
+	if (count_reserve(c, 1))
+		return -1;
+
+	c->limbs[c->num++] = val;
+	return 0;
+}
+
+int count_mul(count_t *c, unsigned int val)
+{
+	unsigned long long carry = 0;
+	int i;
+
+	for (i = 0; i < c->num; i++) {
+		carry += (unsigned long long)c->limbs[i] * val;
+		c->limbs[i] = (unsigned int)carry;
+		carry >>= COUNT_LIMB_BITS;
+	}
+
+	if (carry) {
+		if (count_reserve(c, c->num + 1))
+			return -1;
+		c->limbs[c->num++] = (unsigned int)carry;
+	}
+
+	count_trim(c);
+	return 0;
+}
+
+int count_shl(count_t *c, int bits)
+{
+	int words = bits / COUNT_LIMB_BITS, shift = bits % COUNT_LIMB_BITS, i;
+
+	if (!c->num || !bits)
+		return 0;
+
+	if (count_reserve(c, c->num + words + 1))
+		return -1;
+
+	c->limbs[c->num + words] = 0;
+	for (i = c->num - 1; i >= 0; i--) {
+		unsigned long long limb = (unsigned long long)c->limbs[i] << shift;
+
+		c->limbs[i + words + 1] |= (unsigned int)(limb >>
+			COUNT_LIMB_BITS);
+		c->limbs[i + words] = (unsigned int)limb;
+	}
+	memset(c->limbs, 0, words * sizeof(unsigned int));
+
+	c->num += words + 1;
+	count_trim(c);
+	return 0;
+}
+
+int count_is_zero(count_t *c)
+{
+	return !c->num;
+}
+
+/* the count as an int, INT_MAX if it does not fit */
+int count_int_get(count_t *c)
+{
+	if (!c->num)
+		return 0;
+
+	if (c->num > 1 || c->limbs[0] > INT_MAX)
+		return INT_MAX;
+
+	return c->limbs[0];
+}
+
+/* in decimal: the count is repeatedly divided by 10^9, the remainders being
+ * its decimal digits nine at a time, least significant first */
+void count_print(FILE *out, count_t *c)
+{
+	unsigned int *limbs, *digits;
+	int i, num = c->num, digits_num = 0;
+
+	if (!num) {
+		fprintf(out, "0");
+		return;
+	}
+
+	/* each limb makes for at most two groups of nine digits */
+	if (!(limbs = malloc(num * sizeof(unsigned int))) ||
+		!(digits = malloc(2 * num * sizeof(unsigned int)))) {
+		free(limbs);
+		fprintf(out, "?");
+		return;
+	}
+	memcpy(limbs, c->limbs, num * sizeof(unsigned int));
+
+	while (num) {
+		unsigned long long rem = 0;
+
+		for (i = num - 1; i >= 0; i--) {
+			unsigned long long cur = rem << COUNT_LIMB_BITS |
+				limbs[i];
+
+			limbs[i] = (unsigned int)(cur / COUNT_DEC_BASE);
+			rem = cur % COUNT_DEC_BASE;
+		}
+
+		digits[digits_num++] = (unsigned int)rem;
+		while (num && !limbs[num - 1])
+			num--;
+	}
+
+	fprintf(out, "%u", digits[--digits_num]);
+	while (digits_num--)
+		fprintf(out, "%0*u", COUNT_DEC_DIGITS, digits[digits_num]);
+
+	free(limbs);
+	free(digits);
+}
+
+void count_clr(count_t *c)
+{
+	free(c->limbs);
+	memset(c, 0, sizeof(count_t));
+}
+
@@ -0,0 +1,23 @@
+#ifndef _SAT_COUNT_H_
+#define _SAT_COUNT_H_
+
+#include <stdio.h>
+
+/* an unsigned integer of any size, least significant 32 bit limb first. a
+ * zero count has no limbs */
+typedef struct count_t {
+	unsigned int *limbs;
+	int num;
+	int sz;
+} count_t;
+
+int count_set(count_t *c, unsigned int val);
+int count_mul(count_t *c, unsigned int val);
+int count_shl(count_t *c, int bits);
+int count_is_zero(count_t *c);
+int count_int_get(count_t *c);
+void count_print(FILE *out, count_t *c);
+void count_clr(count_t *c);
+
+#endif
+
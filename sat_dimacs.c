@@ -0,0 +1,206 @@
+#include "sat_dimacs.h"
+#include <stdio.h>
+#include <limits.h>
+
+/* DIMACS CNF:
+ *   c <comment>
+ *   p cnf <variables> <clauses>
+ *   <literal> <literal> ... 0
+ * literals are non zero integers, a negative one being a negation. variables
+ * are numbered 1..<variables> and are used as literal ids as they are */
+
+#define DIMACS_HEADER "cnf"
+
+#define IS_NEWLINE(c) ((c) == '\n')
+#define IS_NUMERIC(c) ('0' <= (c) && (c) <= '9')
+#define IS_NEGATION(c) ((c) == '-')
+#define IS_COMMENT(c) ((c) == 'c')
+#define IS_PROBLEM(c) ((c) == 'p')
+#define IS_END(c) ((c) == '%')
+
+/* line is that of the last character read, a newline included */
+typedef struct dimacs_t {
+	cs_t *cs;
+	FILE *out;
+	int line;
+	int is_eol;
+	int is_problem;
+	int var_num;
+	int clause_num;
+} dimacs_t;
+
+static int is_blank(int c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static int is_space(int c)
+{
+	return is_blank(c) || IS_NEWLINE(c);
+}
+
+static int dimacs_getc(dimacs_t *d)
+{
+	int c;
+
+	if (d->is_eol)
+		d->line++;
+
+	c = cs_getc(d->cs);
+	d->is_eol = IS_NEWLINE(c);
+	return c;
+}
+
+static int dimacs_error(dimacs_t *d, char *err)
+{
+	fprintf(d->out, "dimacs error, line %d: %s\n", d->line, err);
+	return -1;
+}
+
+/* returns the first character which is not white space */
+static int dimacs_space_eat(dimacs_t *d)
+{
+	int c;
+
+	while (is_space(c = dimacs_getc(d)));
+	return c;
+}
+
+static void dimacs_line_eat(dimacs_t *d)
+{
+	int c;
+
+	while (!IS_NEWLINE(c = dimacs_getc(d)) && c != EOF);
+}
+
+/* reads the integer starting at *c, which is no greater than max in absolute
+ * value. *c is left holding the character which follows it */
+static int dimacs_int_get(dimacs_t *d, int *c, int max, int *n)
+{
+	int is_negation = 0;
+	long long val = 0;
+
+	if (IS_NEGATION(*c)) {
+		is_negation = 1;
+		*c = dimacs_getc(d);
+	}
+
+	if (!IS_NUMERIC(*c))
+		return dimacs_error(d, "integer expected");
+
+	for ( ; IS_NUMERIC(*c); *c = dimacs_getc(d)) {
+		if ((val = 10 * val + *c - '0') > max)
+			return dimacs_error(d, "integer out of range");
+	}
+
+	if (*c != EOF && !is_space(*c))
+		return dimacs_error(d, "illegal character");
+
+	*n = is_negation ? -val : val;
+	return 0;
+}
+
+/* reads the problem line up to its clause count, the clauses may follow on
+ * the same line */
+static int dimacs_header_read(dimacs_t *d)
+{
+	char *hdr;
+	int c;
+
+	if (!is_blank(c = dimacs_getc(d)))
+		return dimacs_error(d, "bad problem line");
+
+	while (is_blank(c = dimacs_getc(d)));
+	for (hdr = DIMACS_HEADER; *hdr && c == *hdr; hdr++)
+		c = dimacs_getc(d);
+	if (*hdr || !is_blank(c))
+		return dimacs_error(d, "problem is not of type " DIMACS_HEADER);
+
+	while (is_blank(c = dimacs_getc(d)));
+	if (dimacs_int_get(d, &c, INT_MAX, &d->var_num))
+		return -1;
+	while (is_blank(c))
+		c = dimacs_getc(d);
+	if (dimacs_int_get(d, &c, INT_MAX, &d->clause_num))
+		return -1;
+
+	if (d->var_num < 0 || d->clause_num < 0)
+		return dimacs_error(d, "bad problem line");
+	d->is_problem = 1;
+	return 0;
+}
+
+/* tells whether cs holds a DIMACS CNF rather than an expression. an
+ * expression's first clause starts with a left paren, whereas DIMACS starts
+ * with either a comment or the problem line */
+int dimacs_is(cs_t *cs)
+{
+	int c;
+
+	while (is_space(c = cs_getc(cs)));
+	cs_rewind(cs);
+
+	return IS_COMMENT(c) || IS_PROBLEM(c);
+}
+
+/* reads the DIMACS CNF in cs into clauses. the variable count is taken from
+ * the problem line and literals are interned by number, no variable names are
+ * kept. errors are reported to out */
+int dimacs_read(cs_t *cs, clauses_t **clauses, int *var_num, FILE *out)
+{
+	dimacs_t d = { cs, out ? out : stdout, 1, 0, 0, 0, 0 };
+	int c, cnt = 0, is_open = 0;
+
+	while ((c = dimacs_space_eat(&d)) != EOF && !IS_END(c)) {
+		int lit;
+
+		if (IS_COMMENT(c)) {
+			dimacs_line_eat(&d);
+			continue;
+		}
+
+		if (IS_PROBLEM(c)) {
+			if (d.is_problem)
+				return dimacs_error(&d, "duplicate problem line");
+			if (dimacs_header_read(&d))
+				return -1;
+			if (clause_reserve(clauses, d.clause_num, d.var_num))
+				return dimacs_error(&d, "out of memory");
+			continue;
+		}
+
+		if (!d.is_problem)
+			return dimacs_error(&d, "clause before problem line");
+
+		if (dimacs_int_get(&d, &c, d.var_num, &lit))
+			return -1;
+
+		if (!is_open) {
+			if (++cnt > d.clause_num)
+				return dimacs_error(&d, "too many clauses");
+			if (clause_new(clauses))
+				return dimacs_error(&d, "out of memory");
+			is_open = 1;
+		}
+
+		/* a 0 on its own is an empty clause, which no assignment
+		 * satisfies */
+		if (!lit) {
+			is_open = 0;
+			continue;
+		}
+
+		if (clause_add_id(*clauses, lit < 0 ? -lit : lit, lit > 0))
+			return dimacs_error(&d, "out of memory");
+	}
+
+	if (!d.is_problem)
+		return dimacs_error(&d, "no problem line");
+	if (cnt < d.clause_num)
+		return dimacs_error(&d, "too few clauses");
+
+	/* a last clause missing its terminating 0 is taken as is */
+	*var_num = d.var_num;
+	return 0;
+}
+
@@ -0,0 +1,12 @@
+#ifndef _SAT_DIMACS_H_
+#define _SAT_DIMACS_H_
+
+#include "char_stream.h"
+#include "sat_table.h"
+#include <stdio.h>
+
+int dimacs_is(cs_t *cs);
+int dimacs_read(cs_t *cs, clauses_t **clauses, int *var_num, FILE *out);
+
+#endif
+
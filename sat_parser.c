@@ -42,14 +42,6 @@ typedef enum parse_errno_t {
 	ERR_MEM_ALLOC = 11,
 } parse_errno_t;
 
-typedef struct parser_t {
-	parser_cb_t *cb;
-	cs_t *cs;
-	long error_pos;
-	int error_no;
-} parser_t;
-
-static parser_t parser;
 static void st_clause_start(void *o);
 static void st_literal_pre(void *o);
 
@@ -98,12 +90,12 @@ static int eat_whitespace(cs_t *cs)
 static void clause_new(parser_cb_t *cb)
 {
 	if (cb->clause_new)
-		cb->clause_new();
+		cb->clause_new(cb->data);
 }
 
 static int literal_new(parser_cb_t *cb, char *name, int val)
 {
-	return cb->literal_new ? cb->literal_new(name, val) : 0;
+	return cb->literal_new ? cb->literal_new(cb->data, name, val) : 0;
 }
 
 static int is_quantifier(cs_t *cs, char *quantifier)
@@ -133,6 +125,7 @@ static void st_error(void *o)
 {
 	parser_t *p = (parser_t *)o;
 	cs_t *cs = p->cs;
+	FILE *out = p->cb->out ? p->cb->out : stdout;
 	char c, *err_msg, str[100] = {0};
 
 	switch(p->error_no)
@@ -187,14 +180,14 @@ static void st_error(void *o)
 	}
 
 	cs_rewind(cs);
-	printf("parse error: %s\nCNF expression: ", err_msg);
+	fprintf(out, "parse error: %s\nCNF expression: ", err_msg);
 	while (!is_predicate_end(c = cs_getc(cs))) {
 		char *ch_prefix = cs_getpos(cs) - 1 == p->error_pos ?
 			C_HIGHLIGHT : C_NORMAL;
 
-		printf("%s%c%s", ch_prefix, c, C_NORMAL);
+		fprintf(out, "%s%c%s", ch_prefix, c, C_NORMAL);
 	}
-	printf("%s\n", str);
+	fprintf(out, "%s\n", str);
 
 	event_add(p->cb->fail_cb, p->cb->fail_data);
 }
@@ -419,12 +412,23 @@ Exit:
 	event_add(next_cb, o);
 }
 
-void parser_init(parser_cb_t *cb, cs_t *cs)
+EVENT_PROFILE_START(parser_profile_syms)
+	EVENT_PROFILE_ENTRY(st_error)
+	EVENT_PROFILE_ENTRY(st_clause_end)
+	EVENT_PROFILE_ENTRY(st_literal_post)
+	EVENT_PROFILE_ENTRY(st_literal)
+	EVENT_PROFILE_ENTRY(st_literal_pre)
+	EVENT_PROFILE_ENTRY(st_clause_start)
+EVENT_PROFILE_END
+
+void parser_init(parser_t *p, parser_cb_t *cb, cs_t *cs)
 {
-	parser.cb = cb;
-	parser.cs = cs;
-	parser.error_pos = EOF;
+	p->cb = cb;
+	p->cs = cs;
+	p->error_pos = EOF;
+	p->error_no = 0;
 
-	event_add(st_clause_start, &parser);
+	EVENT_PROFILE_REGISTER(parser_profile_syms);
+	event_add(st_clause_start, p);
 }
 
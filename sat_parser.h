@@ -3,17 +3,27 @@
 
 #include "event.h"
 #include "char_stream.h"
+#include <stdio.h>
 
 typedef struct parser_cb_t {
-	void (*clause_new)(void);
-	int (*literal_new)(char *name, int is_negation);
+	void (*clause_new)(void *data);
+	int (*literal_new)(void *data, char *name, int is_negation);
+	void *data;
 	event_func_t success_cb;
 	void *success_data;
 	event_func_t fail_cb;
 	void *fail_data;
+	FILE *out;
 } parser_cb_t;
 
-void parser_init(parser_cb_t *cb, cs_t *cs);
+typedef struct parser_t {
+	parser_cb_t *cb;
+	cs_t *cs;
+	long error_pos;
+	int error_no;
+} parser_t;
+
+void parser_init(parser_t *p, parser_cb_t *cb, cs_t *cs);
 void parser_uninit(parser_cb_t *cb);
 
 #endif
@@ -0,0 +1,434 @@
+#include "sat_preprocess.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define VAL_UNSET -1
+
+#define MAX(m, n) ((m)<(n) ? (n) : (m))
+
+/* the scratch space of a preprocessing run. clauses are never rewritten while
+ * preprocessing, they are marked dead (satisfied, tautological or subsumed)
+ * and their literals are skipped once assigned. open[] counts the literals
+ * of a clause which are not yet assigned */
+typedef struct pre_work_t {
+	clauses_t *cls;
+	int var_num;
+	int *value;
+	char *dead;
+	int *open;
+	int *occ_start;
+	int *occ;
+	int *queue;
+	int queue_head;
+	int queue_tail;
+	int *mark;
+	int is_unsat;
+} pre_work_t;
+
+static literal_t *pre_literal_get(clauses_t *cls, int clause, int id)
+{
+	literal_t *lit = cls->literals + cls->offsets[clause];
+
+	while (lit->id != id)
+		lit++;
+	return lit;
+}
+
+static void pre_assign(pre_work_t *w, int id, sat_tv_t tv)
+{
+	if (w->value[id] == VAL_UNSET) {
+		w->value[id] = tv;
+		w->queue[w->queue_tail++] = id;
+	}
+	else if (w->value[id] != tv) {
+		w->is_unsat = 1;
+	}
+}
+
+/* clause is down to a single open literal, unless a literal which is
+ * assigned but not yet propagated has already satisfied it */
+static void pre_unit_assign(pre_work_t *w, int clause)
+{
+	clauses_t *cls = w->cls;
+	literal_t *lit = cls->literals + cls->offsets[clause];
+	literal_t *end = lit + cls->dims[clause], *unit = NULL;
+
+	for ( ; lit < end; lit++) {
+		if (w->value[lit->id] == lit->tv) {
+			w->dead[clause] = 1;
+			return;
+		}
+
+		if (w->value[lit->id] == VAL_UNSET)
+			unit = lit;
+	}
+
+	if (unit)
+		pre_assign(w, unit->id, unit->tv);
+}
+
+static void pre_propagate(pre_work_t *w)
+{
+	while (!w->is_unsat && w->queue_head < w->queue_tail) {
+		int id = w->queue[w->queue_head++], i;
+
+		for (i = w->occ_start[id]; i < w->occ_start[id + 1]; i++) {
+			int clause = w->occ[i];
+
+			if (w->dead[clause])
+				continue;
+
+			if (pre_literal_get(w->cls, clause, id)->tv ==
+				w->value[id]) {
+				w->dead[clause] = 1;
+				continue;
+			}
+
+			if (!--w->open[clause]) {
+				w->is_unsat = 1;
+				return;
+			}
+
+			if (w->open[clause] == 1)
+				pre_unit_assign(w, clause);
+		}
+	}
+}
+
+/* tautologies are dropped and unit clauses seed the propagation queue */
+static void pre_units_init(pre_work_t *w)
+{
+	clauses_t *cls = w->cls;
+	int i, j;
+
+	for (i = 0; i < cls->num; i++) {
+		literal_t *lit = cls->literals + cls->offsets[i];
+
+		w->open[i] = cls->dims[i];
+		for (j = 0; j < cls->dims[i]; j++) {
+			if (lit[j].tv == SAT_TV_TAUTOLOGY)
+				w->dead[i] = 1;
+		}
+
+		if (w->dead[i])
+			continue;
+
+		if (!cls->dims[i])
+			w->is_unsat = 1;
+		else if (cls->dims[i] == 1)
+			pre_assign(w, lit->id, lit->tv);
+	}
+}
+
+/* a variable which is left with a single polarity is set to satisfy its
+ * clauses. doing so may leave other variables pure, hence the repeat */
+static void pre_pure_eliminate(pre_work_t *w)
+{
+	clauses_t *cls = w->cls;
+	int is_changed;
+
+	do {
+		int i, j;
+
+		is_changed = 0;
+		memset(w->mark, 0, (w->var_num + 1) * sizeof(int));
+		for (i = 0; i < cls->num; i++) {
+			literal_t *lit = cls->literals + cls->offsets[i];
+
+			if (w->dead[i])
+				continue;
+
+			for (j = 0; j < cls->dims[i]; j++) {
+				if (w->value[lit[j].id] == VAL_UNSET) {
+					w->mark[lit[j].id] |=
+						lit[j].tv == SAT_TV_TRUE ?
+						1 : 2;
+				}
+			}
+		}
+
+		for (i = 1; i <= w->var_num; i++) {
+			if (w->value[i] != VAL_UNSET ||
+				(w->mark[i] != 1 && w->mark[i] != 2)) {
+				continue;
+			}
+
+			pre_assign(w, i, w->mark[i] == 1 ? SAT_TV_TRUE :
+				SAT_TV_FALSE);
+			is_changed = 1;
+		}
+
+		pre_propagate(w);
+	} while (is_changed && !w->is_unsat);
+}
+
+/* drops every clause which contains all the open literals of a smaller (or
+ * an earlier, equal) clause, duplicates included. clauses are visited by
+ * increasing size and each is compared only with the clauses sharing its
+ * least frequent variable */
+static int pre_subsume(pre_work_t *w)
+{
+	clauses_t *cls = w->cls;
+	int *by_size, *start, i, j, dim = clause_dim_get(cls);
+
+	if (!(by_size = calloc(cls->num + dim + 2, sizeof(int))))
+		return -1;
+	start = by_size + cls->num;
+
+	for (i = 0; i < cls->num; i++)
+		start[w->open[i] + 1]++;
+	for (i = 1; i <= dim + 1; i++)
+		start[i] += start[i - 1];
+	for (i = 0; i < cls->num; i++)
+		by_size[start[w->open[i]]++] = i;
+
+	memset(w->mark, 0, (w->var_num + 1) * sizeof(int));
+	for (i = 0; i < cls->num; i++) {
+		int clause = by_size[i], stamp = 2 * (clause + 1), rare = 0;
+		literal_t *lit = cls->literals + cls->offsets[clause];
+
+		if (w->dead[clause])
+			continue;
+
+		for (j = 0; j < cls->dims[clause]; j++) {
+			int id = lit[j].id;
+
+			if (w->value[id] != VAL_UNSET)
+				continue;
+
+			w->mark[id] = stamp + (lit[j].tv == SAT_TV_TRUE);
+			if (!rare || w->occ_start[id + 1] - w->occ_start[id] <
+				w->occ_start[rare + 1] - w->occ_start[rare]) {
+				rare = id;
+			}
+		}
+
+		for (j = w->occ_start[rare]; j < w->occ_start[rare + 1]; j++) {
+			int other = w->occ[j], k, match = 0;
+			literal_t *o = cls->literals + cls->offsets[other];
+
+			if (other == clause || w->dead[other] ||
+				w->open[other] < w->open[clause]) {
+				continue;
+			}
+
+			for (k = 0; k < cls->dims[other]; k++) {
+				if (w->value[o[k].id] == VAL_UNSET &&
+					w->mark[o[k].id] == stamp +
+					(o[k].tv == SAT_TV_TRUE)) {
+					match++;
+				}
+			}
+
+			if (match == w->open[clause])
+				w->dead[other] = 1;
+		}
+	}
+
+	free(by_size);
+	return 0;
+}
+
+static int pre_occ_init(pre_work_t *w)
+{
+	clauses_t *cls = w->cls;
+	int i, j;
+
+	if (!(w->occ = calloc(MAX(cls->literal_num, 1), sizeof(int))))
+		return -1;
+
+	for (i = 0; i < cls->literal_num; i++)
+		w->occ_start[cls->literals[i].id + 1]++;
+	for (i = 1; i <= w->var_num + 1; i++)
+		w->occ_start[i] += w->occ_start[i - 1];
+
+	/* occ_start[] is shifted by one while filling and is restored after */
+	for (i = 0; i < cls->num; i++) {
+		literal_t *lit = cls->literals + cls->offsets[i];
+
+		for (j = 0; j < cls->dims[i]; j++)
+			w->occ[w->occ_start[lit[j].id]++] = i;
+	}
+	for (i = w->var_num + 1; i; i--)
+		w->occ_start[i] = w->occ_start[i - 1];
+	w->occ_start[0] = 0;
+
+	return 0;
+}
+
+/* the open literals of live clauses, over the kept variables renumbered in
+ * increasing order */
+static int pre_reduce(pre_work_t *w, preprocess_t *pre, clauses_t **reduced)
+{
+	clauses_t *cls = w->cls;
+	int i, j, num = w->is_unsat || !cls ? 0 : cls->num;
+
+	memset(w->mark, 0, (w->var_num + 1) * sizeof(int));
+	for (i = 0; i < num; i++) {
+		literal_t *lit = cls->literals + cls->offsets[i];
+
+		if (w->dead[i])
+			continue;
+
+		for (j = 0; j < cls->dims[i]; j++) {
+			if (w->value[lit[j].id] == VAL_UNSET)
+				w->mark[lit[j].id] = 1;
+		}
+	}
+
+	for (i = 1; i <= w->var_num; i++) {
+		if (w->value[i] != VAL_UNSET) {
+			pre->values[i] = w->value[i];
+		}
+		else if (w->mark[i]) {
+			pre->values[i] = SAT_TV_PARADOX;
+			pre->map[++pre->reduced_num] = i;
+			w->mark[i] = pre->reduced_num;
+		}
+		else {
+			pre->values[i] = SAT_TV_TAUTOLOGY;
+		}
+	}
+
+	for (i = 0; i < num; i++) {
+		literal_t *lit = cls->literals + cls->offsets[i];
+
+		if (w->dead[i])
+			continue;
+
+		if (clause_new(reduced))
+			return -1;
+
+		for (j = 0; j < cls->dims[i]; j++) {
+			if (w->value[lit[j].id] == VAL_UNSET &&
+				clause_add_id(*reduced, w->mark[lit[j].id],
+				lit[j].tv == SAT_TV_TRUE)) {
+				return -1;
+			}
+		}
+		pre->clause_num++;
+	}
+
+	return 0;
+}
+
+static void pre_work_clr(pre_work_t *w)
+{
+	free(w->value);
+	free(w->dead);
+	free(w->open);
+	free(w->occ_start);
+	free(w->occ);
+	free(w->queue);
+	free(w->mark);
+}
+
+/* simplifies the expression in *clauses ahead of its CA encoding: drops
+ * tautologies, propagates unit clauses, optionally eliminates pure literals
+ * and finally drops duplicate and subsumed clauses. *clauses is replaced by
+ * the reduced expression, whose variables are renumbered 1..reduced_num.
+ * what was done is recorded in pre so that the assignments of the reduced
+ * expression can be expanded back by preprocess_assignment_get() */
+int preprocess(preprocess_t *pre, clauses_t **clauses, int var_num,
+	int flags)
+{
+	clauses_t *cls = *clauses, *reduced = NULL;
+	pre_work_t w;
+	int i, ret = -1;
+
+	memset(pre, 0, sizeof(preprocess_t));
+	memset(&w, 0, sizeof(pre_work_t));
+	for (i = 0; cls && i < cls->literal_num; i++)
+		var_num = MAX(var_num, cls->literals[i].id);
+
+	w.cls = cls;
+	w.var_num = pre->var_num = var_num;
+	if (!(pre->values = calloc(var_num + 1, sizeof(sat_tv_t))) ||
+		!(pre->map = calloc(var_num + 1, sizeof(int))) ||
+		!(w.value = calloc(var_num + 1, sizeof(int))) ||
+		!(w.occ_start = calloc(var_num + 2, sizeof(int))) ||
+		!(w.queue = calloc(var_num + 1, sizeof(int))) ||
+		!(w.mark = calloc(var_num + 1, sizeof(int)))) {
+		goto Exit;
+	}
+	for (i = 0; i <= var_num; i++)
+		w.value[i] = VAL_UNSET;
+
+	if (cls && cls->num) {
+		if (!(w.dead = calloc(cls->num, sizeof(char))) ||
+			!(w.open = calloc(cls->num, sizeof(int))) ||
+			pre_occ_init(&w)) {
+			goto Exit;
+		}
+
+		pre_units_init(&w);
+		pre_propagate(&w);
+		if (!w.is_unsat && (flags & PRE_PURE_LITERALS))
+			pre_pure_eliminate(&w);
+		if (!w.is_unsat && pre_subsume(&w))
+			goto Exit;
+	}
+
+	pre->is_unsat = w.is_unsat;
+	if (pre_reduce(&w, pre, &reduced))
+		goto Exit;
+
+	clause_clr(clauses);
+	*clauses = reduced;
+	reduced = NULL;
+	ret = 0;
+
+Exit:
+	clause_clr(&reduced);
+	pre_work_clr(&w);
+	if (ret)
+		preprocess_clr(pre);
+	return ret;
+}
+
+/* the number of variables left free: each doubles the number of assignments
+ * of the reduced expression */
+int preprocess_free_num(preprocess_t *pre)
+{
+	int id, free_num = 0;
+
+	for (id = 1; id <= pre->var_num; id++)
+		free_num += pre->values[id] == SAT_TV_TAUTOLOGY;
+	return free_num;
+}
+
+/* expands an assignment of the reduced expression, reduced[] being indexed by
+ * reduced variable id, to one of the original expression. kept variables take
+ * their reduced values, fixed ones their fixed values and free ones the bits
+ * of combination, the first free variable being the most significant */
+void preprocess_assignment_get(preprocess_t *pre, sat_tv_t *reduced,
+	int combination, literal_t *assignment)
+{
+	int id, r = 1, k = preprocess_free_num(pre);
+
+	for (id = 1; id <= pre->var_num; id++) {
+		sat_tv_t tv = pre->values[id];
+
+		if (tv == SAT_TV_PARADOX) {
+			tv = reduced[r++];
+		}
+		else if (tv == SAT_TV_TAUTOLOGY) {
+			/* the free variables beyond the combination's bits
+			 * are always true */
+			tv = --k < (int)sizeof(int) * 8 &&
+				combination >> k & 1 ? SAT_TV_FALSE :
+				SAT_TV_TRUE;
+		}
+
+		assignment[id - 1].id = id;
+		assignment[id - 1].tv = tv;
+	}
+}
+
+void preprocess_clr(preprocess_t *pre)
+{
+	free(pre->values);
+	free(pre->map);
+	memset(pre, 0, sizeof(preprocess_t));
+}
+
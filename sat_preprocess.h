@@ -0,0 +1,34 @@
+#ifndef _SAT_PREPROCESS_H_
+#define _SAT_PREPROCESS_H_
+
+#include "sat_table.h"
+
+/* pure literal elimination keeps the expression satisfyable but drops those
+ * of its assignments in which a pure literal is false. it may therefore only
+ * be used when not all the assignments are looked for */
+#define PRE_PURE_LITERALS (1<<0)
+
+/* what preprocessing made of an expression. values[] is indexed by the
+ * original variable id and holds either the value a variable was fixed to,
+ * SAT_TV_TAUTOLOGY for a variable left free (either value will do) or
+ * SAT_TV_PARADOX for a variable kept in the reduced expression. map[] takes a
+ * reduced variable id back to its original one. the assignments of the
+ * original expression are had one at a time from those of the reduced one */
+typedef struct preprocess_t {
+	int var_num;
+	int reduced_num;
+	int clause_num;
+	int is_unsat;
+	sat_tv_t *values;
+	int *map;
+} preprocess_t;
+
+int preprocess(preprocess_t *pre, clauses_t **clauses, int var_num,
+	int flags);
+int preprocess_free_num(preprocess_t *pre);
+void preprocess_assignment_get(preprocess_t *pre, sat_tv_t *reduced,
+	int combination, literal_t *assignment);
+void preprocess_clr(preprocess_t *pre);
+
+#endif
+
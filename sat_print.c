@@ -1,19 +1,11 @@
 #include "sat_ca.h"
 #include "sat_variable.h"
 #include "sat_table.h"
+#include "sat_count.h"
 #include "util.h"
 #include <stdio.h>
-#include <unistd.h>
 
-static void sat_print(void *o);
-static int dim, print_pause_microsec ;
-
-static void sat_print_set(void *o)
-{
-	event_add(sat_print, o);
-}
-
-static void print_border_vertical(void)
+static void print_border_vertical(int dim)
 {
 	char colour[FMT_COLOUR_SIZE];
 	char field[FMT_COLOUR_SIZE];
@@ -40,12 +32,12 @@ static void print_border_horizontal(void)
 	fprintf(stdout, "%s", field);
 }
 
-static void sat_print(void *o)
+static void sat_print_frame(ca_space_t *s)
 {
-	int i;
+	int i, dim = s->sp_dim;
 
 	fprintf(stdout, FMT_CURSOR_UP, dim + 2);
-	print_border_vertical();
+	print_border_vertical(dim);
 	for (i = 0; i < dim; i++) {
 		int j;
 		char colour[FMT_COLOUR_SIZE];
@@ -55,7 +47,7 @@ static void sat_print(void *o)
 			sat_print_t printer;
 			char field[FMT_COLOUR_SIZE + 12];
 
-			sat_print_params_get(o, i, j, &printer);
+			sat_print_params_get(s, i, j, &printer);
 			sprintf(colour, FMT_COLOUR, printer.is_bright,
 				printer.colour, COL_BCK_BLACK);
 			sprintf(field, "%s%c%s", colour, printer.representation,
@@ -65,72 +57,92 @@ static void sat_print(void *o)
 		print_border_horizontal();
 		fprintf(stdout, "\n");
 	}
-	print_border_vertical();
+	print_border_vertical(dim);
 	fflush(stdout);
+}
 
-	usleep(print_pause_microsec);
-	event_add(sat_print_set, o);
+static void sat_print(void *o)
+{
+	ca_space_t *s = (ca_space_t *)o;
+
+	sat_print_frame(s);
+
+	/* the next frame is drawn once the pause has passed, the generations in
+	 * between run at full speed */
+	event_add_timer(sat_print, o, s->print_pause_microsec);
 }
 
-static void print_speed_set(sat_print_speed_t speed)
+static int print_pause_get(sat_print_speed_t speed)
 {
 	switch (speed)
 	{
 	case SAT_PRINT_SPEED_SLOW:
-		print_pause_microsec = SPEED_SLOW;
-		break;
+		return SPEED_SLOW;
 	case SAT_PRINT_SPEED_FAST:
-		print_pause_microsec = SPEED_RAPID;
-		break;
+		return SPEED_RAPID;
 	case SAT_PRINT_SPEED_MEDIUM:
 	default:
-		print_pause_microsec = SPEED_MEDIUM;
-		break;
+		return SPEED_MEDIUM;
 	}
 }
 
-void sat_print_init(void *o, int space_dim, sat_print_speed_t speed)
+EVENT_PROFILE_START(print_profile_syms)
+	EVENT_PROFILE_ENTRY(sat_print)
+EVENT_PROFILE_END
+
+void sat_print_init(ca_space_t *s, sat_print_speed_t speed)
 {
 	int i;
 
-	dim = space_dim;
-	print_speed_set(speed);
-	event_add(sat_print, o);
+	s->print_pause_microsec = print_pause_get(speed);
+	EVENT_PROFILE_REGISTER(print_profile_syms);
+	event_add(sat_print, s);
 
 	/* initiate printing area */
 	fprintf(stdout, "%s", CURSOR_DISSABLE);
 	fprintf(stdout, "%s", CLEAR_SCREEN);
-	for (i = 0; i < dim + 2; i++)
+	for (i = 0; i < s->sp_dim + 2; i++)
 		fprintf(stdout, "\n");
 	fflush(stdout);
 }
 
-void sat_print_uninit(void)
+/* the final state of the space is drawn last */
+void sat_print_uninit(ca_space_t *s)
 {
+	sat_print_frame(s);
 	fprintf(stdout, "%s", CURSOR_ENABLE);
 	fflush(stdout);
 }
 
-void sat_print_results(table_t *table, variable_t *variables)
+void sat_print_result(FILE *out, int is_satisfyable)
 {
-	int i;
-
-	fprintf(stdout, "expression is %ssatisfyable\n", table->assignment_num ?
+	fprintf(out, "expression is %ssatisfyable\n", is_satisfyable ?
 		"" : "not ");
+}
 
-	for (i = 0; i < table->assignment_num; i++) {
-		int j;
+void sat_print_count(FILE *out, count_t *count)
+{
+	fprintf(out, "number of assignments: ");
+	count_print(out, count);
+	fprintf(out, "\n");
+}
 
-		fprintf(stdout, "assignment %d: ", i + 1);
-		for (j = 0; j < table->var_num; j++) {
-			fprintf(stdout, "%s=%-7s",
-				literal_id2name(variables,
-				table->assignments[i][j].id),
-				table->assignments[i][j].tv ?
-				"TRUE" : "FALSE");
-		}
-		fprintf(stdout, "\n");
+void sat_print_assignment(FILE *out, long long idx, literal_t *assignment,
+	int var_num, variable_t *variables)
+{
+	int i;
+
+	fprintf(out, "assignment %lld: ", idx + 1);
+	for (i = 0; i < var_num; i++) {
+		literal_t *lit = &assignment[i];
+
+		/* DIMACS variables go by their numbers */
+		if (variables)
+			fprintf(out, "%s=", literal_id2name(variables, lit->id));
+		else
+			fprintf(out, "%d=", lit->id);
+		fprintf(out, "%-7s", lit->tv ? "TRUE" : "FALSE");
 	}
-	fflush(stdout);
+	fprintf(out, "\n");
 }
 
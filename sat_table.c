@@ -1,139 +1,183 @@
 #include "sat_table.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define MAX(m, n) ((m)<(n) ? (n) : (m))
 
-static literal_t *literal_alloc(int id, sat_tv_t tv)
+#define CLAUSES_MIN 64
+#define LITERALS_MIN 256
+
+/* grows the array at *arr of *sz elements of size elem_sz to hold at least
+ * num elements, zeroing the new part */
+static int arena_grow(void **arr, int *sz, int num, int elem_sz)
 {
-	literal_t *literal;
+	int new_sz = *sz ? *sz : num;
+	void *tmp;
 
-	if (!(literal = calloc(1, sizeof(literal_t))))
-		return NULL;
+	if (num <= *sz)
+		return 0;
+
+	while (new_sz < num)
+		new_sz *= 2;
 
-	literal->id = id;
-	literal->tv = tv;
-	return literal;
+	if (!(tmp = realloc(*arr, (size_t)new_sz * elem_sz)))
+		return -1;
+
+	memset((char *)tmp + (size_t)*sz * elem_sz, 0,
+		(size_t)(new_sz - *sz) * elem_sz);
+	*arr = tmp;
+	*sz = new_sz;
+	return 0;
 }
 
-static void literal_free(literal_t *literal)
+static int clause_arena_reserve(clauses_t *clauses, int clause_num,
+	int literal_num)
 {
-	free(literal);
+	/* offsets and dims are of the same size */
+	int sz = clauses->sz;
+
+	if (arena_grow((void **)&clauses->offsets, &sz, clause_num,
+		sizeof(int)) || arena_grow((void **)&clauses->dims,
+		&clauses->sz, sz, sizeof(int))) {
+		return -1;
+	}
+
+	return arena_grow((void **)&clauses->literals, &clauses->literal_sz,
+		literal_num, sizeof(literal_t));
 }
 
-static int literal_new(clause_t *clause, char *name, sat_tv_t tv,
-		variable_t **variables)
+/* id 0 stands for the literal's position in the clause. a variable repeated
+ * in a clause is found by its mark, the arena index (plus one) of its literal
+ * which is in the current clause only if it lies beyond the clause's offset */
+static int literal_new(clauses_t *clauses, int id, sat_tv_t tv)
 {
-	int id = 0, cnt = 1;
-	literal_t **literals = &clause->literals;
+	int clause = clauses->num - 1, offset = clauses->offsets[clause];
+	int is_positional = !id;
 
-	if (variables && (id = variable_add(variables, name)) == -1)
-		return -1;
+	if (!is_positional) {
+		int mark;
 
-	while (*literals) {
-		if (id && (*literals)->id == id) {
-			if ((*literals)->tv != tv)
-				(*literals)->tv = SAT_TV_TAUTOLOGY;
+		if (arena_grow((void **)&clauses->marks, &clauses->marks_sz,
+			id + 1, sizeof(int))) {
+			return -1;
+		}
+
+		if ((mark = clauses->marks[id]) > offset) {
+			literal_t *lit = &clauses->literals[mark - 1];
 
+			if (lit->tv != tv)
+				lit->tv = SAT_TV_TAUTOLOGY;
 			return 0;
 		}
+	}
+	else {
+		id = clauses->dims[clause] + 1;
+	}
 
-		literals = &(*literals)->next;
-		cnt++;
+	if (clause_arena_reserve(clauses, clauses->num,
+		clauses->literal_num + 1)) {
+		return -1;
 	}
 
-	clause->dim++;
-	return (*literals = literal_alloc(id ? id : cnt, tv)) ? 0 : -1;
+	clauses->literals[clauses->literal_num].id = id;
+	clauses->literals[clauses->literal_num].tv = tv;
+	clauses->literal_num++;
+	if (!is_positional)
+		clauses->marks[id] = clauses->literal_num;
+	clauses->dims[clause]++;
+	return 0;
 }
 
-void literal_clr(literal_t *literals)
+/* makes room for clause_num clauses over variables 1..var_num up front */
+int clause_reserve(clauses_t **clauses, int clause_num, int var_num)
 {
-	literal_t *tmp;
-
-	while ((tmp = literals)) {
-		literals = literals->next;
-		literal_free(tmp);
-	}
-}
+	if (!*clauses && !(*clauses = calloc(1, sizeof(clauses_t))))
+		return -1;
 
-static clause_t *clause_alloc(int id)
-{
-	clause_t *clause;
+	if (clause_arena_reserve(*clauses, clause_num, LITERALS_MIN))
+		return -1;
 
-	if (!(clause = calloc(1, sizeof(clause_t))))
-		return NULL;
-	clause->id = id;
-	return clause;
+	return arena_grow((void **)&(*clauses)->marks, &(*clauses)->marks_sz,
+		var_num + 1, sizeof(int));
 }
 
-static void clause_free(clause_t *clause)
+/* starts a new, empty, clause at the end of the arena */
+int clause_new(clauses_t **clauses)
 {
-	literal_clr(clause->literals);
-	free(clause);
-}
+	clauses_t *cls = *clauses;
 
-int clause_new(clause_t **clauses)
-{
-	int id = 1;
+	if (!cls && clause_reserve(clauses, CLAUSES_MIN, 0))
+		return -1;
 
-	while (*clauses) {
-		clauses = &(*clauses)->next;
-		id++;
-	}
+	cls = *clauses;
+	if (clause_arena_reserve(cls, cls->num + 1, LITERALS_MIN))
+		return -1;
 
-	return (*clauses = clause_alloc(id)) ? 0 : -1;
+	cls->offsets[cls->num] = cls->literal_num;
+	cls->dims[cls->num] = 0;
+	cls->num++;
+	return 0;
 }
 
-int clause_add(clause_t *clause, char *name, int val, variable_t **variables)
+/* adds a literal to the last clause */
+int clause_add(clauses_t *clauses, char *name, int val, variable_t **variables)
 {
-	while (clause->next)
-		clause = clause->next;
+	int id = 0;
 
-	if (literal_new(clause, name, val ?
-		SAT_TV_TRUE : SAT_TV_FALSE, variables)) {
+	if (!clauses || !clauses->num)
 		return -1;
-	}
 
-	return 0;
+	if (variables && (id = variable_add(variables, name)) == -1)
+		return -1;
+
+	return literal_new(clauses, id, val ? SAT_TV_TRUE : SAT_TV_FALSE);
 }
 
-void clause_clr(clause_t **clauses)
+/* adds the literal of variable id (id > 0) to the last clause */
+int clause_add_id(clauses_t *clauses, int id, int val)
 {
-	clause_t *tmp;
+	if (!clauses || !clauses->num)
+		return -1;
 
-	while ((tmp = *clauses)) {
-		*clauses = (*clauses)->next;
-		clause_free(tmp);
-	}
+	return literal_new(clauses, id, val ? SAT_TV_TRUE : SAT_TV_FALSE);
 }
 
-static int clause_num_cb(int n, clause_t *cls)
+void clause_clr(clauses_t **clauses)
 {
-	return n + 1;
-}
+	clauses_t *cls = *clauses;
 
-static int clause_dim_cb(int n, clause_t *cls)
-{
-	return MAX(n, cls->dim);
+	if (!cls)
+		return;
+
+	free(cls->literals);
+	free(cls->offsets);
+	free(cls->dims);
+	free(cls->marks);
+	free(cls);
+	*clauses = NULL;
 }
 
-static int clause_cnt(clause_t *clauses, int(*cb)(int n, clause_t *cls))
+int clause_num_get(clauses_t *clauses)
 {
-	clause_t *cls;
-	int n = 0;
-
-	for (cls = clauses; cls; cls = cls->next)
-		n = cb(n, cls);
-	return n;
+	return clauses ? clauses->num : 0;
 }
 
-int clause_num_get(clause_t *clauses)
+int clause_dim_get(clauses_t *clauses)
 {
-	return clause_cnt(clauses, clause_num_cb);
+	int i, dim = 0;
+
+	for (i = 0; clauses && i < clauses->num; i++)
+		dim = MAX(dim, clauses->dims[i]);
+	return dim;
 }
 
-int clause_dim_get(clause_t *clauses)
+/* a view of clause idx (0 based). its literals are valid only until the next
+ * literal is added */
+void clause_get(clauses_t *clauses, int idx, clause_t *clause)
 {
-	return clause_cnt(clauses, clause_dim_cb);
+	clause->id = idx + 1;
+	clause->dim = clauses->dims[idx];
+	clause->literals = clauses->literals + clauses->offsets[idx];
 }
 
 void table_clr(table_t *table)
@@ -141,188 +185,149 @@ void table_clr(table_t *table)
 	if (!table)
 		return;
 
-	if (table->t) {
-		int i;
-
-		for (i = 0; i < table->record_num; i++) {
-			if (!table->t[i])
-				break;
-			free(table->t[i]);
-		}
-		free(table->t);
-	}
-
-	if (table->assignments) {
-		int i;
-
-		for (i = 0; i < table->assignment_num; i++)
-			free(table->assignments[i]);
-		free(table->assignments);
-	}
+	free(table->assignments);
 
+	/* the records are allocated along with the table */
 	free(table);
 }
 
+/* a single block holds the table followed by its ids and then its truth
+ * values, both column major */
 static table_t *table_alloc(int record_num, int record_dim)
 {
+	size_t cells = (size_t)record_num * record_dim;
 	table_t *table;
-	int i;
 
-	if (!(table = calloc(1, sizeof(table_t))))
-		goto Error;
+	if (!(table = calloc(1, sizeof(table_t) + cells * sizeof(int) +
+		cells * sizeof(unsigned char)))) {
+		return NULL;
+	}
 
 	table->record_num = record_num;
 	table->record_dim = record_dim;
-
-	if (!(table->t = calloc(record_num, sizeof(literal_t *))))
-		goto Error;
-
-	for (i = 0; i < record_num; i++) {
-		int j;
-
-		if (!(table->t[i] = calloc(record_dim, sizeof(literal_t))))
-			goto Error;
-
-		for (j = 0; j < record_dim; j++) {
-			table->t[i][j].id = 0;
-			table->t[i][j].tv = SAT_TV_TAUTOLOGY;
-		}
-	}
+	table->ids = (int *)(table + 1);
+	table->tvs = (unsigned char *)(table->ids + cells);
+	memset(table->tvs, SAT_TV_TAUTOLOGY, cells);
 
 	return table;
-
-Error:
-	table_clr(table);
-	return NULL;
 }
 
-static int column_sort_compare(int id1, int id2)
+/* fills each clause's column with its literals in increasing id order, in
+ * O(literals + ids): a counting sort of all the literals by id, whose output
+ * is dealt to the columns in order. padding (id 0) is left at the bottom of
+ * each column */
+static int columns_fill(table_t *table, clauses_t *clauses)
 {
-	if (!id1)
-		return 0;
-
-	if (!id2)
-		return 1;
-
-	return id1 <= id2;
-}
+	int lit_num = clauses->literal_num, id_max = 0, i, id;
+	int *cnt, *order, *owner, *fill;
 
-static void column_sort_merge(table_t *table, int clause, int lower_start,
-		int lower_end, int higher_start, int higher_end)
-{
-	int curr = lower_start, *remaining_start = NULL, *remaining_end = NULL;
-
-	while (lower_start <= lower_end && higher_start <= higher_end) {
-		if (column_sort_compare(table->t[lower_start][clause].id,
-			table->t[higher_start][clause].id)) {
-			table->t[curr][0] = table->t[lower_start][clause];
-			lower_start++;
-			remaining_start = &higher_start;
-			remaining_end = &higher_end;
-		}
-		else {
-			table->t[curr][0] = table->t[higher_start][clause];
-			higher_start++;
-			remaining_start = &lower_start;
-			remaining_end = &lower_end;
-		}
+	for (i = 0; i < lit_num; i++)
+		id_max = MAX(id_max, clauses->literals[i].id);
 
-		curr++;
+	if (!(cnt = calloc(id_max + 1 + 2 * lit_num + clauses->num,
+		sizeof(int)))) {
+		return -1;
 	}
+	order = cnt + id_max + 1;
+	owner = order + lit_num;
+	fill = owner + lit_num;
 
-	if (!remaining_start || !remaining_end)
-		return;
+	for (i = 0; i < lit_num; i++)
+		cnt[clauses->literals[i].id]++;
+	for (id = 0, i = 0; id <= id_max; id++) {
+		int n = cnt[id];
 
-	while (*remaining_start <= *remaining_end) {
-		table->t[curr][0] = table->t[*remaining_start][clause];
-		(*remaining_start)++;
-		curr++;
+		cnt[id] = i;
+		i += n;
 	}
-}
-
-static void column_sort_rec(table_t *table, int clause, int start, int end)
-{
-	int mid, curr;
 
-	if (start >= end)
-		return;
+	for (i = 0; i < clauses->num; i++) {
+		int j, offset = clauses->offsets[i];
 
-	mid = (end + start)/2;
-	column_sort_rec(table, clause, start, mid);
-	column_sort_rec(table, clause, mid + 1, end);
-	column_sort_merge(table, clause, start, mid, mid + 1, end);
-	for (curr = start; curr <=end; curr++)
-		table->t[curr][clause] = table->t[curr][0];
-}
+		for (j = offset; j < offset + clauses->dims[i]; j++) {
+			order[cnt[clauses->literals[j].id]++] = j;
+			owner[j] = i;
+		}
+	}
 
-static void columns_sort(table_t *table)
-{
-	int i;
+	for (i = 0; i < lit_num; i++) {
+		literal_t *lit = &clauses->literals[order[i]];
+		int clause = owner[order[i]], pos = fill[clause]++;
 
-	for (i = 1; i < table->record_dim; i++)
-		column_sort_rec(table, i, 0, table->record_num - 1);
-	for (i = 0; i < table->record_num; i++) {
-		table->t[i][0].id = 0;
-		table->t[i][0].tv = SAT_TV_INVERSE(SAT_TV_TAUTOLOGY);
+		TABLE_ID(table, pos, clause + 1) = lit->id;
+		TABLE_TV(table, pos, clause + 1) = SAT_TV_INVERSE(lit->tv);
 	}
+
+	free(cnt);
+	return 0;
 }
 
-table_t *table_create(clause_t *clauses, int var_num)
+table_t *table_create(clauses_t *clauses, int var_num)
 {
 	table_t *table;
 	int i, record_num = clause_dim_get(clauses);
-	int j, record_dim = clause_num_get(clauses);
-	clause_t *cls;
+	int record_dim = clause_num_get(clauses);
 
 	if (!(table = table_alloc(record_num, record_dim + 1)))
 		return NULL;
 
 	table->var_num = var_num;
 	for (i = 0; i < record_num; i++)
-		table->t[i][0].tv = SAT_TV_INVERSE(SAT_TV_TAUTOLOGY);
-
-	for (cls = clauses, i = 1; cls; cls = cls->next, i++) {
-		literal_t *lit;
+		TABLE_TV(table, i, 0) = SAT_TV_INVERSE(SAT_TV_TAUTOLOGY);
 
-		for (lit = cls->literals, j = 0; lit; lit = lit->next, j++) {
-			table->t[j][i].id = lit->id;
-			table->t[j][i].tv = SAT_TV_INVERSE(lit->tv);
-		}
+	if (record_dim && columns_fill(table, clauses)) {
+		table_clr(table);
+		return NULL;
 	}
 
-	columns_sort(table);
 	return table;
 }
 
+#define ASSIGNMENT_WORD(table, idx, id) \
+	((table)->assignments[(size_t)(idx) * (table)->assignment_words + \
+	((id) - 1) / ASSIGNMENT_WORD_BITS])
+#define ASSIGNMENT_BIT(id) (1UL << ((id) - 1) % ASSIGNMENT_WORD_BITS)
+
+/* room for assignment_num all FALSE assignments */
 int table_assignment_init(table_t *table, int assignment_num)
 {
-	int i;
-
-	if (!(table->assignments = calloc(assignment_num, sizeof(literal_t *))))
+	table->assignment_words = (table->var_num + ASSIGNMENT_WORD_BITS - 1) /
+		ASSIGNMENT_WORD_BITS;
+	if (!table->assignment_words)
+		table->assignment_words = 1;
+
+	if (arena_grow((void **)&table->assignments, &table->assignment_sz,
+		assignment_num, table->assignment_words *
+		sizeof(unsigned long))) {
 		return -1;
-
-	for (i = 0; i < assignment_num; i++) {
-		if (!(table->assignments[i] = calloc(table->var_num,
-			sizeof(literal_t)))) {
-			literal_t *tmp;
-
-			for (tmp = table->assignments[0]; tmp; tmp++)
-				free(tmp);
-			free(table->assignments);
-			return -1;
-		}
 	}
 
 	table->assignment_num = assignment_num;
 	return 0;
 }
 
-void table_assignment_insert(table_t *table, int assignment, int id,
-	sat_tv_t tv)
+/* appends an all FALSE assignment, returning its index or -1 */
+int table_assignment_add(table_t *table)
+{
+	int idx = table->assignment_num;
+
+	if (table_assignment_init(table, idx + 1))
+		return -1;
+
+	return idx;
+}
+
+void table_assignment_insert(table_t *table, int idx, int id, sat_tv_t tv)
 {
-	int idx = id -1;
+	if (tv == SAT_TV_TRUE)
+		ASSIGNMENT_WORD(table, idx, id) |= ASSIGNMENT_BIT(id);
+	else
+		ASSIGNMENT_WORD(table, idx, id) &= ~ASSIGNMENT_BIT(id);
+}
 
-	table->assignments[assignment][idx].id = id;
-	table->assignments[assignment][idx].tv = tv;
+sat_tv_t table_assignment_get(table_t *table, int idx, int id)
+{
+	return ASSIGNMENT_WORD(table, idx, id) & ASSIGNMENT_BIT(id) ?
+		SAT_TV_TRUE : SAT_TV_FALSE;
 }
 
@@ -5,36 +5,77 @@
 #include "sat_variable.h"
 
 typedef struct literal_t {
-	struct literal_t *next;
 	int id;
 	sat_tv_t tv;
 } literal_t;
 
+/* a view of one clause of a clauses_t arena */
 typedef struct clause_t {
-	struct clause_t *next;
 	int id;
 	int dim;
 	literal_t *literals;
 } clause_t;
 
+/* the clauses of an expression, kept in a flat arena: the literals of all
+ * clauses back to back, and each clause's offset into them and its dimension.
+ * marks, indexed by variable id, locate a variable's literal in the clause
+ * being built */
+typedef struct clauses_t {
+	literal_t *literals;
+	int literal_num;
+	int literal_sz;
+	int *offsets;
+	int *dims;
+	int num;
+	int sz;
+	int *marks;
+	int marks_sz;
+} clauses_t;
+
+#define TABLE_IDX(table, pos, clause) \
+	((size_t)(clause) * (table)->record_num + (pos))
+#define TABLE_ID(table, pos, clause) \
+	((table)->ids[TABLE_IDX(table, pos, clause)])
+#define TABLE_TV(table, pos, clause) \
+	((table)->tvs[TABLE_IDX(table, pos, clause)])
+#define TABLE_COL_IDS(table, clause) \
+	((table)->ids + TABLE_IDX(table, 0, clause))
+#define TABLE_COL_TVS(table, clause) \
+	((table)->tvs + TABLE_IDX(table, 0, clause))
+
+#define ASSIGNMENT_WORD_BITS (8 * (int)sizeof(unsigned long))
+
+/* record_num literal positions by record_dim clauses (column 0 excluded).
+ * ids and truth values are kept apart, column major, so that the literals of
+ * a clause are consecutive in memory. the satisfying assignments found are
+ * bit sets of assignment_words words each, bit id - 1 set for a TRUE
+ * variable */
 typedef struct table_t {
 	int record_num;
 	int record_dim;
-	literal_t **t;
+	int *ids;
+	unsigned char *tvs;
 	int var_num;
 	int assignment_num;
-	literal_t **assignments;
+	int assignment_sz;
+	int assignment_words;
+	unsigned long *assignments;
 } table_t;
 
-int clause_new(clause_t **clauses);
-int clause_add(clause_t *clause, char *name, int val, variable_t **variables);
-void clause_clr(clause_t **clauses);
-int clause_num_get(clause_t *clauses);
-int clause_dim_get(clause_t *clauses);
+int clause_reserve(clauses_t **clauses, int clause_num, int var_num);
+int clause_new(clauses_t **clauses);
+int clause_add(clauses_t *clauses, char *name, int val, variable_t **variables);
+int clause_add_id(clauses_t *clauses, int id, int val);
+void clause_clr(clauses_t **clauses);
+int clause_num_get(clauses_t *clauses);
+int clause_dim_get(clauses_t *clauses);
+void clause_get(clauses_t *clauses, int idx, clause_t *clause);
 void table_clr(table_t *table);
-table_t *table_create(clause_t *clauses, int var_num);
+table_t *table_create(clauses_t *clauses, int var_num);
 int table_assignment_init(table_t *table, int assignment_num);
+int table_assignment_add(table_t *table);
 void table_assignment_insert(table_t *table, int idx, int id, sat_tv_t tv);
+sat_tv_t table_assignment_get(table_t *table, int idx, int id);
 
 #endif
 
@@ -5,16 +5,24 @@
 #include "sat_variable.h"
 #include "sat_table.h"
 #include "sat_parser.h"
+#include "sat_dimacs.h"
+#include "sat_preprocess.h"
+#include "sat_component.h"
+#include "sat_count.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <pthread.h>
 
 #define MAX_CELLULAR_SPACE_LENGTH 20
 #define MAX_CELLULAR_APACE_HIGHT 8
 
 #define COL_REGISTER_START(c) \
-	static char col[10]; \
+	static char col[16]; \
 	int brightness, colour; \
 	switch (c) \
 	{
@@ -31,7 +39,8 @@
 		colour = COL_WHITE; \
 		break; \
 	} \
-	sprintf(col, "\033[%d;%d;%dm", brightness, colour, COL_BCK_BLACK); \
+	snprintf(col, sizeof(col), "\033[%d;%d;%dm", brightness, colour, \
+		COL_BCK_BLACK); \
 	printf("%s%c%s", col, c, COL_CLEAR); \
 	fflush(stdout);
 
@@ -64,7 +73,7 @@ typedef struct sat_colour_test_entry_t {
 } sat_colour_test_entry_t;
 
 static variable_t *test_variables;
-static clause_t *test_clauses;
+static clauses_t *test_clauses;
 static table_t *test_table;
 static code2str_t trueth_values[] = {
 	{SAT_TV_FALSE, "false"},
@@ -84,16 +93,29 @@ static void test_print(int is_error, char *(* p_func)(char *str, void *data),
 	p_comment(p_func(str, data_recieved), is_error ? "received: " : " ");
 }
 
+/* a table as expected, record by record */
+typedef struct test_table_t {
+	int record_num;
+	int record_dim;
+	literal_t **t;
+} test_table_t;
+
+/* an interned variable as expected, or as received */
+typedef struct test_variable_t {
+	int id;
+	char *name;
+} test_variable_t;
+
 static char *print_variables_str(char *str, void *data)
 {
-	variable_t *var = (variable_t *)data;
+	test_variable_t *var = (test_variable_t *)data;
 
 	sprintf(str, "%%sid: %d, name: %s", var->id, var->name);
 	return str;
 }
 
-static void print_variables(int is_error, variable_t *var_expected,
-	variable_t *var_recieved)
+static void print_variables(int is_error, test_variable_t *var_expected,
+	test_variable_t *var_recieved)
 {
 	test_print(is_error, print_variables_str, var_expected, var_recieved);
 }
@@ -241,24 +263,27 @@ static void print_neighbours(int is_error, int dim, int n, int m,
 	test_print(is_error, print_neighbour_str, &expected, &recieved);
 }
 
-static int assert_variables(variable_t *expected_vars, int sz)
+static int assert_variables(test_variable_t *expected_vars, int sz)
 {
-	variable_t *var;
-	int i, error_code = 0, ret = 0;
+	int i, num = variable_num_get(test_variables), error_code = 0, ret = 0;
 
 	p_comment("variables:");
-	for (var = test_variables, i = 0; var && i < sz; var = var->next, i++) {
+	for (i = 0; i < num && i < sz; i++) {
+		test_variable_t var = {
+			.id = i + 1,
+			.name = literal_id2name(test_variables, i + 1),
+		};
 		int print_error = 0;
 
-		if (!error_code && (var->id != expected_vars[i].id ||
-			strcmp(var->name, expected_vars[i].name))) {
+		if (!error_code && (var.id != expected_vars[i].id ||
+			strcmp(var.name, expected_vars[i].name))) {
 			error_code = 1;
 			print_error = 1;
 		}
-		print_variables(print_error, &expected_vars[i], var);
+		print_variables(print_error, &expected_vars[i], &var);
 	}
 
-	if (i < sz || var)
+	if (i < sz || i < num)
 		error_code += 2;
 
 	if (error_code) {
@@ -271,27 +296,26 @@ static int assert_variables(variable_t *expected_vars, int sz)
 
 static int assert_clauses(clause_t *expected_clauses, int sz)
 {
-	clause_t *cls;
 	int clause_error = 0, literal_error = 0, literal_error_found = 0,
 		ret = 0;
-	int i;
+	int i, num = clause_num_get(test_clauses);
 
 	p_comment("clauses:");
-	for (cls = test_clauses, i = 0; cls && i < sz; cls = cls->next, i++) {
-		literal_t *lit;
+	for (i = 0; i < num && i < sz; i++) {
+		clause_t cls;
 		literal_t *expected_literals = expected_clauses[i].literals;
 		int j, print_error_clause = 0;
 
-		if (!clause_error && (cls->id != expected_clauses[i].id ||
-			cls->dim != expected_clauses[i].dim)) {
+		clause_get(test_clauses, i, &cls);
+		if (!clause_error && (cls.id != expected_clauses[i].id ||
+			cls.dim != expected_clauses[i].dim)) {
 			clause_error = 1;
 			print_error_clause = 1;
 		}
-		print_clauses(print_error_clause, &expected_clauses[i], cls);
+		print_clauses(print_error_clause, &expected_clauses[i], &cls);
 
-		for (lit = cls->literals,
-			j = 0; lit && j < expected_clauses[i].dim;
-			lit = lit->next, j++) {
+		for (j = 0; j < cls.dim && j < expected_clauses[i].dim; j++) {
+			literal_t *lit = &cls.literals[j];
 			int error_print_literal = 0;
 
 			if (!literal_error_found &&
@@ -305,7 +329,7 @@ static int assert_clauses(clause_t *expected_clauses, int sz)
 		}
 
 		if (!literal_error_found &&
-			(j < expected_clauses[i].dim || lit)) {
+			(j < expected_clauses[i].dim || j < cls.dim)) {
 			literal_error += 2;
 		}
 
@@ -313,7 +337,7 @@ static int assert_clauses(clause_t *expected_clauses, int sz)
 			literal_error_found = 1;
 	}
 
-	if (i < sz || cls)
+	if (i < sz || i < num)
 		clause_error += 2;
 
 	if (clause_error || literal_error) {
@@ -325,7 +349,7 @@ static int assert_clauses(clause_t *expected_clauses, int sz)
 	return ret;
 }
 
-static int assert_table(table_t *expected_table)
+static int assert_table(test_table_t *expected_table)
 {
 	int i; int j;
 	int is_error = 0;
@@ -346,20 +370,21 @@ static int assert_table(table_t *expected_table)
 
 	p_comment("table:");
 	for (i = 0; i < expected_table->record_num; i++) {
+		literal_t record[expected_table->record_dim];
 		int print_error = 0;
 
 		for (j = 0; j < expected_table->record_dim; j++) {
+			record[j].id = TABLE_ID(test_table, i, j);
+			record[j].tv = TABLE_TV(test_table, i, j);
 			if (!is_error &&
-				(expected_table->t[i][j].id !=
-				test_table->t[i][j].id ||
-				expected_table->t[i][j].tv !=
-				test_table->t[i][j].tv)) {
+				(expected_table->t[i][j].id != record[j].id ||
+				expected_table->t[i][j].tv != record[j].tv)) {
 				is_error = 1;
 				print_error = 1;
 			}
 		}
 		print_table(print_error, expected_table->record_dim,
-			expected_table->t[i], test_table->t[i]);
+			expected_table->t[i], record);
 	}
 
 Exit:
@@ -394,22 +419,23 @@ static int assert_neighbours(coordinate_euclid_t **table, int hight,
 	return ret;
 }
 
-static int test_variable_new(char *name, int val)
+static int test_variable_new(void *data, char *name, int val)
 {
 	return variable_add(&test_variables, name) == -1 ? -1 : 0;
 }
 
-static void test_clause_new(void)
+static void test_clause_new(void *data)
 {
 	clause_new(&test_clauses);
 }
 
-static int test_literal_new(char *name, int val)
+static int test_literal_new(void *data, char *name, int val)
 {
 	return clause_add(test_clauses, name, val, NULL);
 }
 
-static int test_literal_new_w_var(char *name, int val)
+static int test_literal_new_w_var(void *data, char *name,
+	int val)
 {
 	return clause_add(test_clauses, name, val, &test_variables);
 }
@@ -446,12 +472,13 @@ static void parse_should_fail_fail(void *o)
 }
 
 /* generic cnf parse test */
-static int test_sat_parser(void (*clause_new)(void),
-	int (*literal_new)(char *name, int val), event_func_t success,
-	event_func_t fail, char *cnf)
+static int test_sat_parser(void (*clause_new)(void *data),
+	int (*literal_new)(void *data, char *name, int val),
+	event_func_t success, event_func_t fail, char *cnf)
 {
 	sat_test_event_t t;
 	cs_t *cs;
+	parser_t parser;
 	parser_cb_t parser_cb = {
 		.clause_new = clause_new,
 		.literal_new = literal_new,
@@ -464,7 +491,7 @@ static int test_sat_parser(void (*clause_new)(void),
 	p_comment("test expression: \"%s\"", cnf);
 	cs = cs_open(CS_STRING2CHAR, cnf);
 	event_init();
-	parser_init(&parser_cb, cs);
+	parser_init(&parser, &parser_cb, cs);
 	event_loop();
 	event_uninit();
 	cs_close(cs);
@@ -748,7 +775,7 @@ static int test25(void)
 static void test26_success(void *o)
 {
 	int res;
-	variable_t expected_vars[4] = {
+	test_variable_t expected_vars[4] = {
 		{.id=1, .name="a"},
 		{.id=2, .name="b"},
 		{.id=3, .name="c"},
@@ -808,7 +835,7 @@ static int test27(void)
 
 static void test28_success(void *o)
 {
-	variable_t expected_vars[4] = {
+	test_variable_t expected_vars[4] = {
 		{.id=1, .name="a"},
 		{.id=2, .name="b"},
 		{.id=3, .name="c"},
@@ -855,7 +882,7 @@ static int test28(void)
 
 static void test29_success(void *o)
 {
-	variable_t expected_vars[4] = {
+	test_variable_t expected_vars[4] = {
 		{.id=1, .name="a"},
 		{.id=2, .name="b"},
 		{.id=3, .name="c"},
@@ -903,7 +930,7 @@ static int test29(void)
 
 static void test30_success(void *o)
 {
-	variable_t expected_vars[4] = {
+	test_variable_t expected_vars[4] = {
 		{.id=1, .name="a"},
 		{.id=2, .name="b"},
 		{.id=3, .name="c"},
@@ -957,7 +984,7 @@ static void test30_success(void *o)
 		expected_literal_array2,
 		expected_literal_array3,
 	};
-	table_t expected_table = {
+	test_table_t expected_table = {
 		.record_num=3,
 		.record_dim=5,
 		.t=expected_literal_table,
@@ -987,7 +1014,7 @@ static int test30(void)
 
 static void test31_success(void *o)
 {
-	variable_t expected_vars[4] = {
+	test_variable_t expected_vars[4] = {
 		{.id=1, .name="a"},
 		{.id=2, .name="b"},
 		{.id=3, .name="c"},
@@ -1078,7 +1105,7 @@ static void test31_success(void *o)
 		expected_literal_array3,
 		expected_literal_array4,
 	};
-	table_t expected_table = {
+	test_table_t expected_table = {
 		.record_num=4,
 		.record_dim=7,
 		.t=expected_literal_table,
@@ -1177,6 +1204,1100 @@ static int test32(void)
 	return assert_neighbours(co_table, 3, 3, expected, recieved);
 }
 
+static void test33_count(void *o)
+{
+	(*(int *)o)++;
+}
+
+static int test33(void)
+{
+#define EVENT_NUM 3000
+
+	static int counters[EVENT_NUM];
+	event_pool_stat_t stat;
+	int i, ret = 0;
+
+	event_init();
+	for (i = 0; i < EVENT_NUM; i++) {
+		counters[i] = 0;
+		if (event_add_once(test33_count, &counters[i]) ||
+			event_add_once(test33_count, &counters[i])) {
+			ret = -1;
+		}
+	}
+	event_pool_stat_get(EVENT_POOL_EVENT, &stat);
+	p_comment("events pending: %lu, slabs: %lu", stat.in_use, stat.slabs);
+	if (stat.in_use != EVENT_NUM)
+		ret = -1;
+
+	event_loop();
+	for (i = 0; i < EVENT_NUM; i++) {
+		if (counters[i] != 1)
+			ret = -1;
+	}
+	event_pool_stat_get(EVENT_POOL_EVENT, &stat);
+	p_comment("events pending: %lu, high water mark: %lu", stat.in_use,
+		stat.high_water);
+	if (stat.in_use || stat.high_water != EVENT_NUM)
+		ret = -1;
+	event_uninit();
+
+	return ret;
+
+#undef EVENT_NUM
+}
+
+static void test34_read(int fd, void *o)
+{
+	char c;
+
+	if (read(fd, &c, 1) == 1)
+		*(char *)o = c;
+}
+
+static void test34_write(void *o)
+{
+	if (write(*(int *)o, "x", 1) != 1)
+		p_comment("could not write to pipe");
+}
+
+static int test34(void)
+{
+	int pfd[2], ret = 0;
+	char c = 0;
+
+	if (pipe(pfd))
+		return -1;
+
+	event_init();
+	/* the write is queued as an event, the loop has to wait for the read
+	 * end to become ready before it may terminate */
+	if (fd_add(pfd[0], FD_READ, test34_read, &c) ||
+		event_add(test34_write, &pfd[1])) {
+		ret = -1;
+	}
+	else if (event_loop() || c != 'x') {
+		ret = -1;
+	}
+	p_comment("read from pipe: '%c'", c ? c : ' ');
+	event_uninit();
+
+	close(pfd[0]);
+	close(pfd[1]);
+	return ret;
+}
+
+static void test35_expire(void *o)
+{
+	static int order;
+
+	*(int *)o = ++order;
+}
+
+static int test35(void)
+{
+	int expired[4] = {0}, ret = 0;
+	struct timeval start, end;
+	long elapsed;
+
+	event_init();
+	gettimeofday(&start, NULL);
+	if (event_add_timer(test35_expire, &expired[0], 30000) ||
+		event_add_timer(test35_expire, &expired[1], 10000) ||
+		event_add_timer(test35_expire, &expired[2], 20000) ||
+		event_add_timer(test35_expire, &expired[3], 5000)) {
+		ret = -1;
+	}
+	event_del_timer(&expired[3]);
+	event_loop();
+	gettimeofday(&end, NULL);
+	event_uninit();
+
+	elapsed = (end.tv_sec - start.tv_sec) * 1000000 +
+		end.tv_usec - start.tv_usec;
+	p_comment("expiry order: %d %d %d %d, elapsed: %ldus", expired[0],
+		expired[1], expired[2], expired[3], elapsed);
+	if (expired[0] != 3 || expired[1] != 1 || expired[2] != 2 ||
+		expired[3] || elapsed < 30000) {
+		ret = -1;
+	}
+
+	return ret;
+}
+
+#define TEST36_THREADS 4
+#define TEST36_ROUNDS 200
+
+typedef struct test36_run_t {
+	char *cnf;
+	int clause_num;
+	int var_num;
+	clauses_t *clauses;
+	variable_t *variables;
+	int ret;
+} test36_run_t;
+
+static void test36_clause_new(void *data)
+{
+	clause_new(&((test36_run_t *)data)->clauses);
+}
+
+static int test36_literal_new(void *data, char *name, int val)
+{
+	test36_run_t *r = (test36_run_t *)data;
+
+	return clause_add(r->clauses, name, val, &r->variables);
+}
+
+static void test36_success(void *o)
+{
+	test36_run_t *r = (test36_run_t *)o;
+
+	if (clause_num_get(r->clauses) != r->clause_num ||
+		variable_num_get(r->variables) != r->var_num) {
+		r->ret = -1;
+	}
+	clause_clr(&r->clauses);
+	variables_clr(&r->variables);
+}
+
+static void test36_fail(void *o)
+{
+	((test36_run_t *)o)->ret = -1;
+}
+
+/* each thread repeatedly parses its own expression on an event loop of its
+ * own */
+static void *test36_thread(void *o)
+{
+	test36_run_t *r = (test36_run_t *)o;
+	parser_t parser;
+	parser_cb_t parser_cb = {
+		.clause_new = test36_clause_new,
+		.literal_new = test36_literal_new,
+		.data = r,
+		.success_cb = test36_success,
+		.success_data = r,
+		.fail_cb = test36_fail,
+		.fail_data = r,
+	};
+	cs_t *cs;
+	int i;
+
+	if (!(cs = cs_open(CS_STRING2CHAR, r->cnf)) || event_init()) {
+		r->ret = -1;
+		goto Exit;
+	}
+
+	for (i = 0; i < TEST36_ROUNDS && !r->ret; i++) {
+		cs_rewind(cs);
+		parser_init(&parser, &parser_cb, cs);
+		if (event_loop())
+			r->ret = -1;
+	}
+	event_uninit();
+
+Exit:
+	if (cs)
+		cs_close(cs);
+	return NULL;
+}
+
+static int test36(void)
+{
+	test36_run_t runs[TEST36_THREADS] = {
+		{ .cnf = "(a or b)", .clause_num = 1, .var_num = 2 },
+		{ .cnf = "(a or -b) and (c)", .clause_num = 2, .var_num = 3 },
+		{ .cnf = "(x1) and (x2 or -x3) and (-x1 or x4)",
+			.clause_num = 3, .var_num = 4 },
+		{ .cnf = "(p) and (q) and (r) and (s or t)", .clause_num = 4,
+			.var_num = 5 },
+	};
+	pthread_t threads[TEST36_THREADS];
+	int i, n, ret = 0;
+
+	for (n = 0; n < TEST36_THREADS; n++) {
+		if (pthread_create(&threads[n], NULL, test36_thread, &runs[n]))
+			break;
+	}
+
+	for (i = 0; i < n; i++)
+		pthread_join(threads[i], NULL);
+	if (n < TEST36_THREADS)
+		return -1;
+
+	for (i = 0; i < TEST36_THREADS; i++) {
+		p_comment("thread %d: \"%s\" %s", i, runs[i].cnf,
+			runs[i].ret ? "failed" : "parsed");
+		if (runs[i].ret)
+			ret = -1;
+	}
+
+	return ret;
+}
+
+static int test37_compare(cs_t *file, cs_t *mmap)
+{
+	int c;
+
+	do {
+		if ((c = cs_getc(file)) != cs_getc(mmap) ||
+			cs_getpos(file) != cs_getpos(mmap)) {
+			return -1;
+		}
+	} while (c != EOF);
+
+	return 0;
+}
+
+static int test37(void)
+{
+	char file[] = "/tmp/sat_test_XXXXXX", *cnf = "(a or -b) and (c)\n\xff\n";
+	cs_t *cs_file = NULL, *cs_mmap = NULL;
+	int fd, ret = -1;
+
+	if ((fd = mkstemp(file)) == -1)
+		return -1;
+	if (write(fd, cnf, strlen(cnf)) != strlen(cnf))
+		goto Exit;
+
+	p_comment("%s is read as a %s stream", file,
+		cs_file_type(file) == CS_MMAP2CHAR ? "mapped" : "stdio");
+	if (cs_file_type(file) != CS_MMAP2CHAR)
+		goto Exit;
+
+	if (!(cs_file = cs_open(CS_FILE2CHAR, file)) ||
+		!(cs_mmap = cs_open(CS_MMAP2CHAR, file))) {
+		goto Exit;
+	}
+
+	/* both streams must agree on every character and position, also after
+	 * stepping back and rewinding, and a 0xff byte must not read as EOF */
+	if (test37_compare(cs_file, cs_mmap))
+		goto Exit;
+
+	cs_rewind(cs_file);
+	cs_rewind(cs_mmap);
+	cs_getc(cs_file);
+	cs_getc(cs_mmap);
+	if (cs_getc(cs_mmap) != 'a' || cs_ungetc(cs_mmap) != 'a' ||
+		cs_getpos(cs_mmap) != 1 || cs_setpos(cs_mmap, 100) != -1 ||
+		cs_setpos(cs_mmap, 1) || cs_getc(cs_mmap) != ' ') {
+		goto Exit;
+	}
+
+	cs_rewind(cs_file);
+	cs_rewind(cs_mmap);
+	ret = test37_compare(cs_file, cs_mmap);
+
+Exit:
+	if (cs_file)
+		cs_close(cs_file);
+	if (cs_mmap)
+		cs_close(cs_mmap);
+	close(fd);
+	unlink(file);
+	return ret;
+}
+
+static int test38_read(char *cnf, int *var_num, FILE *out)
+{
+	cs_t *cs;
+	int ret = -1;
+
+	if (!(cs = cs_open(CS_STRING2CHAR, cnf)))
+		return -1;
+
+	if (dimacs_is(cs))
+		ret = dimacs_read(cs, &test_clauses, var_num, out);
+	cs_close(cs);
+	return ret;
+}
+
+static int test38(void)
+{
+	literal_t expected_literals1[2] = {
+		{.id=1, .tv=SAT_TV_TRUE},
+		{.id=3, .tv=SAT_TV_FALSE},
+	};
+	literal_t expected_literals2[3] = {
+		{.id=2, .tv=SAT_TV_TAUTOLOGY},
+		{.id=3, .tv=SAT_TV_TRUE},
+		{.id=5, .tv=SAT_TV_TRUE},
+	};
+	literal_t expected_literals3[1] = {
+		{.id=4, .tv=SAT_TV_FALSE},
+	};
+	clause_t expected_clauses[3] = {
+		{.id = 1, .dim = 2, .literals = expected_literals1},
+		{.id = 2, .dim = 3, .literals = expected_literals2},
+		{.id = 3, .dim = 1, .literals = expected_literals3},
+	};
+	char *bad[] = {
+		"p cnf 2 1\n1 3 0\n",
+		"p cnf 2 1\n1 2 0\n1 0\n",
+		"p cnf 2 1\n1 x 0\n",
+		"p cnf -1 1\n",
+		"p cnf 2 2\n1 2 0\n",
+		"p cnf 2 1 x\n1 2 0\n",
+		"p dnf 2 1\n1 2 0\n",
+		"c no problem line\n",
+	};
+	clause_t clause;
+	char *err = NULL;
+	size_t len = 0;
+	FILE *out;
+	int i, var_num = 0, ret = -1;
+
+	/* a clause may span lines and duplicate literals merge as they do in
+	 * an expression */
+	if (test38_read("c a comment\n"
+		"p cnf 5 3\n"
+		"1 -3 0\n"
+		"2 3\n"
+		"-2 5 0 -4\n", &var_num, NULL)) {
+		goto Exit;
+	}
+
+	p_comment("variables: %d", var_num);
+	if (var_num != 5 ||
+		assert_clauses(expected_clauses, ARRAY_SZ(expected_clauses))) {
+		goto Exit;
+	}
+	clause_clr(&test_clauses);
+
+	if (!(out = fopen("/dev/null", "w")))
+		goto Exit;
+
+	for (i = 0; i < ARRAY_SZ(bad); i++) {
+		if (!test38_read(bad[i], &var_num, out))
+			break;
+		clause_clr(&test_clauses);
+	}
+	fclose(out);
+
+	if (i < ARRAY_SZ(bad)) {
+		p_comment("bad input accepted: %s", bad[i]);
+		goto Exit;
+	}
+
+	/* a 0 on its own is an empty clause, and a problem may be empty */
+	if (test38_read("p cnf 2 2\n1 2 0\n0\n", &var_num, NULL) ||
+		clause_num_get(test_clauses) != 2) {
+		goto Exit;
+	}
+	clause_get(test_clauses, 1, &clause);
+	if (clause.dim)
+		goto Exit;
+	clause_clr(&test_clauses);
+
+	if (test38_read("p cnf 0 0\n", &var_num, NULL) || var_num ||
+		clause_num_get(test_clauses)) {
+		goto Exit;
+	}
+	clause_clr(&test_clauses);
+
+	/* errors are reported on the line of the offending token */
+	if (!(out = open_memstream(&err, &len)))
+		goto Exit;
+	i = test38_read("p cnf 2 2\n1 2 0\n0 x\n", &var_num, out);
+	fclose(out);
+	p_comment("%s", err);
+	if (!i || !strstr(err, "line 3:"))
+		goto Exit;
+
+	ret = 0;
+
+Exit:
+	free(err);
+	clause_clr(&test_clauses);
+	return ret;
+}
+
+#define TEST39_VARS 10000
+
+/* names are interned in order of first appearance, whatever the number of
+ * variables */
+static int test39(void)
+{
+	variable_t *variables = NULL;
+	char name[MAX_VARIABLE_SZ];
+	int i, ret = -1;
+
+	for (i = 0; i < 2 * TEST39_VARS; i++) {
+		snprintf(name, sizeof(name), "v%d", i % TEST39_VARS);
+		if (variable_add(&variables, name) != i % TEST39_VARS + 1) {
+			p_comment("%s was not given id %d", name,
+				i % TEST39_VARS + 1);
+			goto Exit;
+		}
+	}
+
+	p_comment("variables: %d", variable_num_get(variables));
+	if (variable_num_get(variables) != TEST39_VARS)
+		goto Exit;
+
+	for (i = 0; i < TEST39_VARS; i++) {
+		snprintf(name, sizeof(name), "v%d", i);
+		if (strcmp(literal_id2name(variables, i + 1), name))
+			goto Exit;
+	}
+
+	if (strcmp(literal_id2name(variables, TEST39_VARS + 1), "unknown"))
+		goto Exit;
+
+	ret = 0;
+
+Exit:
+	variables_clr(&variables);
+	return ret;
+}
+
+#define TEST40_CLAUSES 1000
+
+/* clauses keep their literals across arena growth and a variable repeated
+ * within a clause is merged only with its literal in that same clause */
+static int test40(void)
+{
+	int i, ret = -1;
+
+	for (i = 0; i < TEST40_CLAUSES; i++) {
+		if (clause_new(&test_clauses) ||
+			clause_add_id(test_clauses, i + 1, 1) ||
+			clause_add_id(test_clauses, i + 2, 0) ||
+			clause_add_id(test_clauses, i + 1, i % 2)) {
+			goto Exit;
+		}
+	}
+
+	p_comment("clauses: %d, dimension: %d", clause_num_get(test_clauses),
+		clause_dim_get(test_clauses));
+	if (clause_num_get(test_clauses) != TEST40_CLAUSES ||
+		clause_dim_get(test_clauses) != 2) {
+		goto Exit;
+	}
+
+	for (i = 0; i < TEST40_CLAUSES; i++) {
+		clause_t cls;
+
+		clause_get(test_clauses, i, &cls);
+		if (cls.id != i + 1 || cls.dim != 2 ||
+			cls.literals[0].id != i + 1 ||
+			cls.literals[0].tv != (i % 2 ? SAT_TV_TRUE :
+			SAT_TV_TAUTOLOGY) ||
+			cls.literals[1].id != i + 2 ||
+			cls.literals[1].tv != SAT_TV_FALSE) {
+			p_comment("clause %d is corrupt", i + 1);
+			goto Exit;
+		}
+	}
+
+	ret = 0;
+
+Exit:
+	clause_clr(&test_clauses);
+	return ret;
+}
+
+#define TEST41_CLAUSES 200000
+#define TEST41_VARS 20000
+#define TEST41_DIM_MAX 8
+
+/* table creation on a large random formula: every column must come out in
+ * increasing id order, padding last */
+static int test41(void)
+{
+	unsigned int seed = 41;
+	struct timeval start, end;
+	int i, j, ret = -1;
+
+	for (i = 0; i < TEST41_CLAUSES; i++) {
+		int dim = 1 + rand_r(&seed) % TEST41_DIM_MAX;
+
+		if (clause_new(&test_clauses))
+			goto Exit;
+		for (j = 0; j < dim; j++) {
+			if (clause_add_id(test_clauses,
+				1 + rand_r(&seed) % TEST41_VARS,
+				rand_r(&seed) % 2)) {
+				goto Exit;
+			}
+		}
+	}
+
+	gettimeofday(&start, NULL);
+	test_table = table_create(test_clauses, TEST41_VARS);
+	gettimeofday(&end, NULL);
+	if (!test_table)
+		goto Exit;
+
+	p_comment("%d clauses, %d literals: table created in %ldus",
+		TEST41_CLAUSES, test_clauses->literal_num,
+		(end.tv_sec - start.tv_sec) * 1000000 +
+		end.tv_usec - start.tv_usec);
+
+	for (i = 1; i < test_table->record_dim; i++) {
+		int *ids = TABLE_COL_IDS(test_table, i);
+		clause_t cls;
+
+		clause_get(test_clauses, i - 1, &cls);
+		for (j = 1; j < test_table->record_num; j++) {
+			if (j < cls.dim ? ids[j] <= ids[j - 1] : ids[j])
+				break;
+		}
+
+		if (j < test_table->record_num || !ids[0]) {
+			p_comment("clause %d is out of order", i);
+			goto Exit;
+		}
+	}
+
+	ret = 0;
+
+Exit:
+	clause_clr(&test_clauses);
+	table_clr(test_table);
+	test_table = NULL;
+	return ret;
+}
+
+static int test42_clauses_add(int (*clauses)[3], int num)
+{
+	int i, j;
+
+	for (i = 0; i < num; i++) {
+		if (clause_new(&test_clauses))
+			return -1;
+
+		for (j = 0; j < 3 && clauses[i][j]; j++) {
+			int lit = clauses[i][j];
+
+			if (clause_add_id(test_clauses, lit < 0 ? -lit : lit,
+				lit > 0)) {
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* units, duplicates, subsumed clauses and tautologies are taken out and the
+ * reduced assignments are expanded back over all the variables */
+static int test42(void)
+{
+	int clauses[][3] = {
+		{ 1 }, { -1, 2 }, { 3, 4 }, { 4, 3 }, { 3, 4, 5 }, { 6, -6 },
+	};
+	int unsat[][3] = { { 1, 2 }, { -1 }, { -2 } };
+	sat_tv_t values[7] = { 0, SAT_TV_TRUE, SAT_TV_TRUE, SAT_TV_PARADOX,
+		SAT_TV_PARADOX, SAT_TV_TAUTOLOGY, SAT_TV_TAUTOLOGY };
+	sat_tv_t expanded[6] = { SAT_TV_TRUE, SAT_TV_TRUE, SAT_TV_TRUE,
+		SAT_TV_FALSE, SAT_TV_FALSE, SAT_TV_TRUE };
+	sat_tv_t reduced[3];
+	literal_t assignment[6];
+	preprocess_t pre = { 0 };
+	int i, ret = -1;
+
+	if (test42_clauses_add(clauses, ARRAY_SZ(clauses)) ||
+		preprocess(&pre, &test_clauses, 6, 0)) {
+		goto Exit;
+	}
+
+	p_comment("variables: %d, clauses: %d, unsat: %d", pre.reduced_num,
+		pre.clause_num, pre.is_unsat);
+	if (pre.reduced_num != 2 || pre.clause_num != 1 || pre.is_unsat ||
+		pre.map[1] != 3 || pre.map[2] != 4 ||
+		memcmp(values, pre.values, sizeof(values))) {
+		goto Exit;
+	}
+
+	/* (3=TRUE, 4=FALSE) with 5=FALSE, 6=TRUE, 5 being the more significant
+	 * of the free variables */
+	reduced[1] = SAT_TV_TRUE;
+	reduced[2] = SAT_TV_FALSE;
+	if (preprocess_free_num(&pre) != 2)
+		goto Exit;
+	preprocess_assignment_get(&pre, reduced, 2, assignment);
+	for (i = 0; i < 6; i++) {
+		if (assignment[i].id != i + 1 ||
+			assignment[i].tv != expanded[i]) {
+			goto Exit;
+		}
+	}
+	preprocess_clr(&pre);
+
+	/* pure literals satisfy what is left */
+	if (preprocess(&pre, &test_clauses, 2, PRE_PURE_LITERALS) ||
+		pre.clause_num || pre.values[1] != SAT_TV_TRUE ||
+		pre.values[2] != SAT_TV_TRUE) {
+		goto Exit;
+	}
+	preprocess_clr(&pre);
+	clause_clr(&test_clauses);
+
+	if (test42_clauses_add(unsat, ARRAY_SZ(unsat)) ||
+		preprocess(&pre, &test_clauses, 2, 0) || !pre.is_unsat) {
+		goto Exit;
+	}
+
+	ret = 0;
+
+Exit:
+	preprocess_clr(&pre);
+	clause_clr(&test_clauses);
+	return ret;
+}
+
+/* (1 or 2) and (3) and (2 or -1) and (4 or 5) falls apart into three
+ * components whose assignments are combined lazily, the largest component
+ * being the most significant */
+static int test43(void)
+{
+	int clauses[][3] = { { 1, 2 }, { 3 }, { 2, -1 }, { 4, 5 } };
+	int maps[][3] = { { 0, 1, 2 }, { 0, 4, 5 }, { 0, 3 } };
+	int dims[] = { 2, 2, 1 };
+	sat_tv_t values[6];
+	components_t comps = { 0 };
+	int i, j, ret = -1;
+
+	if (test42_clauses_add(clauses, ARRAY_SZ(clauses)) ||
+		components_split(&comps, test_clauses, 5, 1)) {
+		goto Exit;
+	}
+
+	p_comment("components: %d", comps.num);
+	if (comps.num != 3)
+		goto Exit;
+
+	for (i = 0; i < comps.num; i++) {
+		component_t *comp = &comps.comps[i];
+
+		if (comp->var_num != dims[i])
+			goto Exit;
+		for (j = 1; j <= comp->var_num; j++) {
+			if (comp->map[j] != maps[i][j])
+				goto Exit;
+		}
+
+		/* stand in for the CA: every combination of the component's
+		 * variables but the first is an assignment */
+		if (!(comp->table = table_create(comp->clauses, comp->var_num)) ||
+			table_assignment_init(comp->table,
+			(1 << comp->var_num) - 1)) {
+			goto Exit;
+		}
+		for (j = 1; j < 1 << comp->var_num; j++) {
+			int k;
+
+			for (k = 0; k < comp->var_num; k++) {
+				table_assignment_insert(comp->table, j - 1,
+					k + 1, j >> k & 1 ? SAT_TV_TRUE :
+					SAT_TV_FALSE);
+			}
+		}
+	}
+
+	p_comment("assignments: %lld", components_assignment_num(&comps));
+	if (components_assignment_num(&comps) != 9)
+		goto Exit;
+
+	/* 7 = 2 * 3 + 1: the 3rd of {1, 2}, the 2nd of {4, 5} and 3=TRUE */
+	components_assignment_get(&comps, 7, values);
+	if (values[1] != SAT_TV_TRUE || values[2] != SAT_TV_TRUE ||
+		values[3] != SAT_TV_TRUE || values[4] != SAT_TV_FALSE ||
+		values[5] != SAT_TV_TRUE) {
+		goto Exit;
+	}
+	components_clr(&comps);
+
+	/* unsplit, there is a single component with all the variables */
+	if (components_split(&comps, test_clauses, 5, 0) || comps.num != 1 ||
+		comps.comps[0].var_num != 5) {
+		goto Exit;
+	}
+
+	ret = 0;
+
+Exit:
+	components_clr(&comps);
+	clause_clr(&test_clauses);
+	return ret;
+}
+
+/* assignments of more variables than there are bits in a word, added one
+ * at a time */
+static int test44(void)
+{
+	int i, id, var_num = 2 * ASSIGNMENT_WORD_BITS + 3, ret = -1;
+	table_t *table;
+
+	if (!(table = calloc(1, sizeof(table_t))))
+		return -1;
+	table->var_num = var_num;
+
+	for (i = 0; i < 100; i++) {
+		if (table_assignment_add(table) != i)
+			goto Exit;
+
+		for (id = 1; id <= var_num; id++) {
+			table_assignment_insert(table, i, id, (id + i) % 3 ?
+				SAT_TV_FALSE : SAT_TV_TRUE);
+		}
+	}
+
+	p_comment("assignments: %d, words per assignment: %d",
+		table->assignment_num, table->assignment_words);
+	if (table->assignment_num != 100 || table->assignment_words != 3)
+		goto Exit;
+
+	for (i = 0; i < 100; i++) {
+		for (id = 1; id <= var_num; id++) {
+			if (table_assignment_get(table, i, id) != ((id + i) % 3 ?
+				SAT_TV_FALSE : SAT_TV_TRUE)) {
+				goto Exit;
+			}
+		}
+	}
+
+	ret = 0;
+
+Exit:
+	table_clr(table);
+	return ret;
+}
+
+/* 3^45 * 2^70 in decimal, past what a long long holds */
+static int test45(void)
+{
+	char *expected = "3487836826332890698160249998717337450053632";
+	count_t count = { 0 };
+	char *buf = NULL;
+	size_t len = 0;
+	FILE *out;
+	int i, ret = -1;
+
+	if (count_set(&count, 1))
+		goto Exit;
+
+	for (i = 0; i < 45; i++) {
+		if (count_mul(&count, 3))
+			goto Exit;
+	}
+
+	if (count_shl(&count, 70) || count_int_get(&count) != INT_MAX)
+		goto Exit;
+
+	if (!(out = open_memstream(&buf, &len)))
+		goto Exit;
+	count_print(out, &count);
+	fclose(out);
+
+	p_comment("count: %s", buf);
+	if (strcmp(buf, expected))
+		goto Exit;
+
+	if (count_mul(&count, 0) || !count_is_zero(&count))
+		goto Exit;
+
+	ret = 0;
+
+Exit:
+	free(buf);
+	count_clr(&count);
+	return ret;
+}
+
+/* the combinations of more free variables than there are bits in an int
+ * leave the more significant ones true */
+static int test46(void)
+{
+	int i, var_num = (int)sizeof(int) * 8 + 8, ret = -1;
+	literal_t *assignment = NULL;
+	preprocess_t pre = { 0 };
+	sat_tv_t reduced[1];
+
+	for (i = 1; i <= var_num; i++) {
+		if (clause_new(&test_clauses) ||
+			clause_add_id(test_clauses, i, 1) ||
+			clause_add_id(test_clauses, i, 0)) {
+			goto Exit;
+		}
+	}
+
+	if (!(assignment = calloc(var_num, sizeof(literal_t))) ||
+		preprocess(&pre, &test_clauses, var_num, 0)) {
+		goto Exit;
+	}
+
+	p_comment("free variables: %d", preprocess_free_num(&pre));
+	if (preprocess_free_num(&pre) != var_num)
+		goto Exit;
+
+	preprocess_assignment_get(&pre, reduced, 1, assignment);
+	for (i = 0; i < var_num; i++) {
+		if (assignment[i].tv != (i == var_num - 1 ? SAT_TV_FALSE :
+			SAT_TV_TRUE)) {
+			goto Exit;
+		}
+	}
+
+	ret = 0;
+
+Exit:
+	free(assignment);
+	preprocess_clr(&pre);
+	clause_clr(&test_clauses);
+	return ret;
+}
+
+/* the clauses may follow the problem line on the same line, which is how a
+ * DIMACS CNF is given on the command line */
+static int test47(void)
+{
+	literal_t expected_literals1[2] = {
+		{.id=1, .tv=SAT_TV_TRUE},
+		{.id=2, .tv=SAT_TV_FALSE},
+	};
+	literal_t expected_literals2[1] = {
+		{.id=2, .tv=SAT_TV_TRUE},
+	};
+	clause_t expected_clauses[2] = {
+		{.id = 1, .dim = 2, .literals = expected_literals1},
+		{.id = 2, .dim = 1, .literals = expected_literals2},
+	};
+	int var_num = 0, ret = -1;
+
+	if (test38_read("p cnf 2 1 1 -2 0", &var_num, NULL) ||
+		var_num != 2 ||
+		assert_clauses(expected_clauses, 1)) {
+		goto Exit;
+	}
+	clause_clr(&test_clauses);
+
+	if (test38_read("p cnf 2 2 1 -2 0 2 0\n", &var_num, NULL) ||
+		assert_clauses(expected_clauses, ARRAY_SZ(expected_clauses))) {
+		goto Exit;
+	}
+
+	ret = 0;
+
+Exit:
+	clause_clr(&test_clauses);
+	return ret;
+}
+
+static int test_line_cmp(const void *a, const void *b)
+{
+	return strcmp(*(char **)a, *(char **)b);
+}
+
+/* runs s and returns what it wrote with the assignments' numbers dropped and
+ * its lines sorted, so that runs finding the same assignments in different
+ * orders compare equal. s is freed */
+static char *test_sat_run(sat_ctx_t *s)
+{
+	char *out = NULL, *sorted = NULL, **lines = NULL, *line, *pos;
+	size_t len = 0;
+	int i, num = 0;
+	FILE *f;
+
+	if (!(f = open_memstream(&out, &len)))
+		goto Exit;
+	sat_ctx_output_set(s, f);
+	i = sat_ctx_run(s);
+	fclose(f);
+	if (i < 0 || !(lines = calloc(len + 1, sizeof(char *))) ||
+		!(sorted = calloc(len + 1, 1))) {
+		goto Exit;
+	}
+
+	for (line = strtok(out, "\n"); line; line = strtok(NULL, "\n")) {
+		if (!strncmp(line, "assignment ", 11) &&
+			(pos = strchr(line, ':'))) {
+			line = pos + 1;
+		}
+		lines[num++] = line;
+	}
+
+	qsort(lines, num, sizeof(char *), test_line_cmp);
+	for (i = 0; i < num; i++) {
+		strcat(sorted, lines[i]);
+		strcat(sorted, "\n");
+	}
+
+Exit:
+	sat_ctx_free(s);
+	free(lines);
+	free(out);
+	return sorted;
+}
+
+static sat_ctx_t *test_sat_new(char *cnf)
+{
+	sat_ctx_t *s;
+	cs_t *cs;
+
+	if (!(cs = cs_open(CS_STRING2CHAR, cnf)))
+		return NULL;
+
+	if (!(s = sat_ctx_new(cs)))
+		cs_close(cs);
+	return s;
+}
+
+static char *test48_cnfs[] = {
+	"(a or -b) and (b or c) and (c or -d)",
+	"(a or b or c) and (-a or -b) and (-c or d) and (b or -d)",
+	"(a or b) and (-a or b) and (a or -b)",
+	"(a or b) and (-a or -b) and (a or -b) and (-a or b)",
+	"(a or -b or c) and (-a or d) and (b or -c or -d) and (c or e) and "
+		"(-e or a)",
+};
+
+/* a growing arm advances by the scans it marks its neighbour for, so the
+ * synchronous engine only finds the event driven engine's assignments if
+ * its neighbours are marked as they should be */
+static int test48(void)
+{
+	char *expected = NULL, *found = NULL;
+	sat_ctx_t *s;
+	int i, ret = -1;
+
+	for (i = 0; i < ARRAY_SZ(test48_cnfs); i++) {
+		p_comment("%s", test48_cnfs[i]);
+		if (!(s = test_sat_new(test48_cnfs[i])) ||
+			!(expected = test_sat_run(s))) {
+			goto Exit;
+		}
+
+		if (!(s = test_sat_new(test48_cnfs[i])))
+			goto Exit;
+		sat_ctx_sync_set(s, 1);
+		if (!(found = test_sat_run(s)) || strcmp(expected, found))
+			goto Exit;
+
+		free(expected);
+		free(found);
+		expected = found = NULL;
+	}
+
+	ret = 0;
+
+Exit:
+	free(expected);
+	free(found);
+	return ret;
+}
+
+/* with a tile's threshold of a single cell, every generation of more cells
+ * due than there are threads is split into tiles */
+static int test49(void)
+{
+	char *expected = NULL, *found = NULL;
+	int threads[] = { 2, 3, 4 };
+	sat_ctx_t *s;
+	int i, j, ret = -1;
+
+	for (i = 0; i < ARRAY_SZ(test48_cnfs); i++) {
+		p_comment("%s", test48_cnfs[i]);
+		if (!(s = test_sat_new(test48_cnfs[i])))
+			goto Exit;
+		sat_ctx_sync_set(s, 1);
+		if (!(expected = test_sat_run(s)))
+			goto Exit;
+
+		for (j = 0; j < ARRAY_SZ(threads); j++) {
+			if (!(s = test_sat_new(test48_cnfs[i])))
+				goto Exit;
+			sat_ctx_sync_set(s, 1);
+			sat_ctx_sync_threads_set(s, threads[j]);
+			sat_ctx_tile_cells_min_set(s, 1);
+			if (!(found = test_sat_run(s)) || strcmp(expected, found))
+				goto Exit;
+
+			free(found);
+			found = NULL;
+		}
+
+		free(expected);
+		expected = NULL;
+	}
+
+	ret = 0;
+
+Exit:
+	free(expected);
+	free(found);
+	return ret;
+}
+
+/* (a or b) and (-b or c) has a and c for pure literals. listing all its
+ * assignments keeps them in the reduced expression, looking for a single one
+ * fixes them and leaves b free */
+static int test50(void)
+{
+	int clauses[][3] = { { 1, 2 }, { -2, 3 } };
+	char *cnf = "(a or b) and (-b or c)";
+	char *all = " a=FALSE  b=TRUE   c=TRUE   \n"
+		" a=TRUE   b=FALSE  c=FALSE  \n"
+		" a=TRUE   b=FALSE  c=TRUE   \n"
+		" a=TRUE   b=TRUE   c=TRUE   \n"
+		"expression is satisfyable\n";
+	char *one = " a=TRUE   b=TRUE   c=TRUE   \n"
+		"expression is satisfyable\n";
+	char *found = NULL;
+	preprocess_t pre = { 0 };
+	sat_ctx_t *s;
+	int ret = -1;
+
+	if (test42_clauses_add(clauses, ARRAY_SZ(clauses)) ||
+		preprocess(&pre, &test_clauses, 3, 0)) {
+		goto Exit;
+	}
+
+	p_comment("all assignments - variables: %d, clauses: %d",
+		pre.reduced_num, pre.clause_num);
+	if (pre.reduced_num != 3 || pre.clause_num != 2)
+		goto Exit;
+	preprocess_clr(&pre);
+	clause_clr(&test_clauses);
+
+	if (test42_clauses_add(clauses, ARRAY_SZ(clauses)) ||
+		preprocess(&pre, &test_clauses, 3, PRE_PURE_LITERALS)) {
+		goto Exit;
+	}
+
+	p_comment("single assignment - variables: %d, clauses: %d",
+		pre.reduced_num, pre.clause_num);
+	if (pre.reduced_num || pre.clause_num ||
+		pre.values[1] != SAT_TV_TRUE || pre.values[3] != SAT_TV_TRUE ||
+		pre.values[2] != SAT_TV_TAUTOLOGY) {
+		goto Exit;
+	}
+
+	if (!(s = test_sat_new(cnf)) || !(found = test_sat_run(s)) ||
+		strcmp(found, all)) {
+		goto Exit;
+	}
+	free(found);
+	found = NULL;
+
+	if (!(s = test_sat_new(cnf)))
+		goto Exit;
+	sat_ctx_assignment_max_set(s, 1);
+	if (!(found = test_sat_run(s)) || strcmp(found, one))
+		goto Exit;
+
+	ret = 0;
+
+Exit:
+	free(found);
+	preprocess_clr(&pre);
+	clause_clr(&test_clauses);
+	return ret;
+}
+
 static int test51(void)
 {
 	test_colours(COL_TEST_ITER_0);
@@ -1332,6 +2453,78 @@ static test_t sat_tests[] =
 		description: "neighbours",
 		func: test32,
 	},
+	{
+		description: "event pool and pending event index",
+		func: test33,
+	},
+	{
+		description: "fd events",
+		func: test34,
+	},
+	{
+		description: "timer events",
+		func: test35,
+	},
+	{
+		description: "concurrent event loops",
+		func: test36,
+	},
+	{
+		description: "memory mapped character stream",
+		func: test37,
+	},
+	{
+		description: "DIMACS CNF input",
+		func: test38,
+	},
+	{
+		description: "variable interning",
+		func: test39,
+	},
+	{
+		description: "clause arena",
+		func: test40,
+	},
+	{
+		description: "linear time table creation",
+		func: test41,
+	},
+	{
+		description: "CNF preprocessing",
+		func: test42,
+	},
+	{
+		description: "independent components",
+		func: test43,
+	},
+	{
+		description: "bit packed assignments",
+		func: test44,
+	},
+	{
+		description: "arbitrary precision assignment count",
+		func: test45,
+	},
+	{
+		description: "more free variables than an int has bits",
+		func: test46,
+	},
+	{
+		description: "DIMACS CNF on a single line",
+		func: test47,
+	},
+	{
+		description: "synchronous and event driven engines agree",
+		func: test48,
+	},
+	{
+		description: "tiled and single threaded synchronous engines agree",
+		func: test49,
+	},
+	{
+		description: "pure literals go only for a single assignment",
+		func: test50,
+	},
 	{
 		description: "colour combinations - iteration 0",
 		func: test51,
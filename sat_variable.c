@@ -3,52 +3,162 @@
 #include <stdio.h>
 #include <string.h>
 
-static variable_t *variable_alloc(char *name, int id)
+#define VARIABLE_HASH_MIN 64
+#define VARIABLE_NAMES_MIN 32
+#define VARIABLE_POOL_MIN 256
+
+#define FNV_OFFSET 2166136261U
+#define FNV_PRIME 16777619U
+
+typedef struct variable_name_t {
+	unsigned int hash;
+	int offset;
+} variable_name_t;
+
+/* variables are interned: an open addressing hash table maps names to ids,
+ * which are handed out in order of first appearance starting at 1. names are
+ * kept back to back in a single pool and are indexed by id */
+struct variable_t {
+	int *hash;
+	int hash_sz;
+	variable_name_t *names;
+	int names_sz;
+	int num;
+	char *pool;
+	int pool_len;
+	int pool_sz;
+};
+
+static unsigned int variable_hash(char *name)
 {
-	variable_t *var;
+	unsigned int hash = FNV_OFFSET;
 
-	if (!(var = calloc(1, sizeof(variable_t))))
-		return NULL;
+	for ( ; *name; name++)
+		hash = (hash ^ (unsigned char)*name) * FNV_PRIME;
+	return hash;
+}
 
-	snprintf(var->name, sizeof(var->name), "%s", name);
-	var->id = id;
-	return var;
+/* the slot of name, or the empty slot it is to be inserted at */
+static int *variable_slot(variable_t *vars, char *name, unsigned int hash)
+{
+	int mask = vars->hash_sz - 1, i;
+
+	for (i = hash & mask; vars->hash[i]; i = (i + 1) & mask) {
+		variable_name_t *n = &vars->names[vars->hash[i]];
+
+		if (n->hash == hash && !strcmp(vars->pool + n->offset, name))
+			break;
+	}
+
+	return &vars->hash[i];
 }
 
-static void variable_free(variable_t *var)
+/* doubles the hash table, keeping it at most half full */
+static int variable_hash_grow(variable_t *vars)
 {
-	free(var);
+	int *hash, sz = vars->hash_sz ? 2 * vars->hash_sz : VARIABLE_HASH_MIN;
+	int mask = sz - 1, id;
+
+	if (!(hash = calloc(sz, sizeof(int))))
+		return -1;
+
+	for (id = 1; id <= vars->num; id++) {
+		int i;
+
+		for (i = vars->names[id].hash & mask; hash[i];
+			i = (i + 1) & mask);
+		hash[i] = id;
+	}
+
+	free(vars->hash);
+	vars->hash = hash;
+	vars->hash_sz = sz;
+	return 0;
 }
 
-int variable_add(variable_t **variables, char *name)
+static int variable_name_add(variable_t *vars, char *name, unsigned int hash)
 {
-	int cnt = 1;
+	int len = strlen(name) + 1;
 
-	for ( ; *variables; variables = &(*variables)->next) {
-		if (!strcmp((*variables)->name, name))
-			return (*variables)->id;
+	/* ids index names from 1 */
+	if (vars->num + 1 >= vars->names_sz) {
+		int sz = vars->names_sz ? 2 * vars->names_sz :
+			VARIABLE_NAMES_MIN;
+		variable_name_t *names;
 
-		cnt++;
+		if (!(names = realloc(vars->names,
+			sz * sizeof(variable_name_t)))) {
+			return -1;
+		}
+		vars->names = names;
+		vars->names_sz = sz;
 	}
 
-	return ((*variables) = variable_alloc(name, cnt)) ?
-		(*variables)->id : -1;
+	if (vars->pool_len + len > vars->pool_sz) {
+		int sz = vars->pool_sz ? vars->pool_sz : VARIABLE_POOL_MIN;
+		char *pool;
+
+		while (sz < vars->pool_len + len)
+			sz *= 2;
+		if (!(pool = realloc(vars->pool, sz)))
+			return -1;
+		vars->pool = pool;
+		vars->pool_sz = sz;
+	}
+
+	vars->num++;
+	vars->names[vars->num].hash = hash;
+	vars->names[vars->num].offset = vars->pool_len;
+	memcpy(vars->pool + vars->pool_len, name, len);
+	vars->pool_len += len;
+	return vars->num;
+}
+
+int variable_add(variable_t **variables, char *name)
+{
+	variable_t *vars = *variables;
+	unsigned int hash = variable_hash(name);
+	int *slot, id;
+
+	if (!vars && !(vars = *variables = calloc(1, sizeof(variable_t))))
+		return -1;
+
+	if (2 * (vars->num + 1) > vars->hash_sz && variable_hash_grow(vars))
+		return -1;
+
+	if (*(slot = variable_slot(vars, name, hash)))
+		return *slot;
+
+	if ((id = variable_name_add(vars, name, hash)) == -1)
+		return -1;
+
+	return *slot = id;
 }
 
 void variables_clr(variable_t **variables)
 {
-	variable_t *tmp;
+	variable_t *vars = *variables;
 
-	while ((tmp = *variables)) {
-		*variables = (*variables)->next;
-		variable_free(tmp);
-	}
+	if (!vars)
+		return;
+
+	free(vars->hash);
+	free(vars->names);
+	free(vars->pool);
+	free(vars);
+	*variables = NULL;
+}
+
+int variable_num_get(variable_t *variables)
+{
+	return variables ? variables->num : 0;
 }
 
 char *literal_id2name(variable_t *variables, int id)
 {
-	for (; variables && variables->id != id; variables = variables->next);
+	if (!variables || id < 1 || id > variables->num)
+		return "unknown";
 
-	return variables ? variables->name : "unknown";
+	return variables->pool + variables->names[id].offset;
 }
 
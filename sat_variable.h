@@ -3,14 +3,11 @@
 
 #include "sat.h"
 
-typedef struct variable_t {
-	struct variable_t *next;
-	int id;
-	char name[MAX_VARIABLE_SZ];
-} variable_t;
+typedef struct variable_t variable_t;
 
 int variable_add(variable_t **variables, char *name);
 void variables_clr(variable_t **variables);
+int variable_num_get(variable_t *variables);
 char *literal_id2name(variable_t *variables, int id);
 
 #endif